@@ -0,0 +1,494 @@
+
+/******************************************************************************
+ * batch_queries.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdlib.h>
+
+#include "batch_queries.h"
+#include "binary_trees.h"
+#include "util.h"
+#include "basic.h"
+
+/*
+ * Each in-flight query follows the same steps of fwd_search/bwd_search:
+ * - LEAF: scan of the chunk of i
+ * - SIBLING: scan of the adjacent chunk (right chunk for fwd_search, left
+ *   chunk for bwd_search)
+ * - SCAN: instead of SIBLING, find_close and find_open check the next (or
+ *   previous) st->scan_chunks leaves of the min-max tree, as they do outside
+ *   of the batches (see fwd_search_adaptive)
+ * - UP: climb of the min-max tree, checking one sibling per level
+ * - DOWN: descent to the leaf that contains the answer
+ * - LAST: scan of that leaf
+ * Every step ends after issuing the prefetch of the data needed by the next
+ * one.
+ */
+enum { PH_LEAF, PH_SIBLING, PH_SCAN, PH_UP, PH_DOWN, PH_LAST };
+
+struct query_state_t {
+  long q;           // Index of the query in the batch
+  int32_t i;        // Initial position
+  int32_t d;        // Relative excess of the search
+  int32_t target;   // Excess value searched in the min-max tree
+  int32_t excess;   // Excess value up to the ith position (bwd_search)
+  long node;        // Current node of the min-max tree
+  int phase;
+  int only_match;   // It only answers parentheses of the matching type
+};
+
+typedef struct query_state_t query_state;
+
+static inline void prefetch_chunk(rmMt* st, long chunk) {
+  __builtin_prefetch(&(st->bit_array)->words[(chunk*st->s)>>logW]);
+  __builtin_prefetch(&(st->bit_array)->words[((chunk+1)*st->s-1)>>logW]);
+}
+
+static inline void prefetch_node(rmMt* st, long node) {
+  __builtin_prefetch(&st->m_prime[node]);
+  __builtin_prefetch(&st->M_prime[node]);
+}
+
+static inline int in_node(rmMt* st, long node, int32_t target) {
+  return st->m_prime[node] <= target && target <= st->M_prime[node];
+}
+
+static void init_query(rmMt* st, query_state* qs, const int32_t* I, int32_t d,
+		       long q, int only_match) {
+  long chunk = I[q] / st->s;
+
+  qs->q = q;
+  qs->i = I[q];
+  qs->d = d;
+  qs->phase = PH_LEAF;
+  qs->only_match = only_match;
+
+  // sum() reads the chunk of i and the excess value of the previous chunk
+  prefetch_chunk(st, chunk);
+  if(chunk)
+    __builtin_prefetch(&st->e_prime[chunk-1]);
+}
+
+/*
+ * Forward search
+ */
+
+// It climbs the min-max tree until it finds a right sibling to check
+static int fwd_climb(rmMt* st, query_state* qs, int32_t* res) {
+  long node = qs->node;
+
+  while(!is_root(node)) {
+    if(is_left_child(node)) {
+      qs->node = right_sibling(node);
+      qs->phase = PH_UP;
+      prefetch_node(st, qs->node);
+      return 0;
+    }
+    node = parent(node);
+  }
+
+  *res = qs->i;
+  return 1;
+}
+
+// It moves the query to the leaf (or the children) of 'node'
+static int fwd_descend(rmMt* st, query_state* qs, long node) {
+  if(is_leaf(node, st)) {
+    long chunk = node - st->internal_nodes;
+    qs->node = node;
+    qs->phase = PH_LAST;
+    prefetch_chunk(st, chunk);
+    __builtin_prefetch(&st->e_prime[chunk-1]);
+  }
+  else {
+    qs->node = left_child(node);
+    qs->phase = PH_DOWN;
+    prefetch_node(st, qs->node); // The right child is the next position
+  }
+  return 0;
+}
+
+// It executes one step of a forward search. It returns 1 if the query is
+// finished (the answer is stored in 'res') and 0 otherwise
+static int fwd_step(rmMt* st, query_state* qs, int32_t* res) {
+  long chunk, node;
+  int32_t output;
+
+  switch(qs->phase) {
+  case PH_LEAF:
+    if(qs->only_match && bit_array_get_bit(st->bit_array, qs->i) == 0) {
+      *res = qs->i;
+      return 1;
+    }
+
+    qs->excess = sum(st, qs->i);
+    qs->target = qs->excess + qs->d - 1;
+    output = check_leaf_r(st, qs->i, qs->target, qs->excess);
+    if(output > qs->i) {
+      *res = output;
+      return 1;
+    }
+
+    chunk = qs->i / st->s;
+    if(qs->only_match) {
+      qs->node = st->internal_nodes + chunk + 1;
+      qs->phase = PH_SCAN;
+      prefetch_node(st, qs->node);
+      return 0;
+    }
+
+    if(chunk%2 == 0 && chunk+1 < st->num_chunks) { // The current chunk has a right sibling
+      qs->node = st->internal_nodes + chunk + 1;
+      qs->phase = PH_SIBLING;
+      prefetch_node(st, qs->node);
+      prefetch_chunk(st, chunk + 1);
+      __builtin_prefetch(&st->e_prime[chunk]);
+      return 0;
+    }
+
+    qs->node = parent(st->internal_nodes + chunk);
+    return fwd_climb(st, qs, res);
+
+  case PH_SIBLING:
+    chunk = qs->node - st->internal_nodes;
+    if(in_node(st, qs->node, qs->target)) {
+      output = check_sibling_r(st, st->s*chunk, qs->target);
+      if(output >= st->s*chunk) {
+	*res = output;
+	return 1;
+      }
+    }
+
+    qs->node = parent(qs->node);
+    return fwd_climb(st, qs, res);
+
+  case PH_SCAN:
+    chunk = min(qs->i / st->s + (long)st->scan_chunks, (long)st->num_chunks - 1);
+    for(node = qs->node; node <= st->internal_nodes + chunk; node++)
+      if(in_node(st, node, qs->target))
+	return fwd_descend(st, qs, node);
+
+    if(chunk == st->num_chunks - 1) {
+      *res = qs->i;
+      return 1;
+    }
+
+    // Go up and down in the min-max tree from the last scanned leaf
+    qs->node = st->internal_nodes + chunk;
+    return fwd_climb(st, qs, res);
+
+  case PH_UP:
+    if(in_node(st, qs->node, qs->target))
+      return fwd_descend(st, qs, qs->node);
+
+    qs->node = parent(qs->node);
+    return fwd_climb(st, qs, res);
+
+  case PH_DOWN:
+    node = qs->node;
+    if(!in_node(st, node, qs->target)) {
+      node = right_sibling(node);
+      if(!in_node(st, node, qs->target)) {
+	*res = qs->i;
+	return 1;
+      }
+    }
+    return fwd_descend(st, qs, node);
+
+  case PH_LAST:
+  default:
+    chunk = qs->node - st->internal_nodes;
+    *res = check_sibling_r(st, st->s*chunk, qs->target);
+    return 1;
+  }
+}
+
+/*
+ * Backward search
+ */
+
+// It climbs the min-max tree until it finds a left sibling to check
+static int bwd_climb(rmMt* st, query_state* qs, int32_t* res) {
+  long node = qs->node;
+
+  while(!is_root(node)) {
+    if(is_right_child(node)) {
+      qs->node = left_sibling(node);
+      qs->phase = PH_UP;
+      prefetch_node(st, qs->node);
+      return 0;
+    }
+    node = parent(node);
+  }
+
+  // Special case: the answer is the first position (see bwd_search)
+  if(qs->target == 0)
+    *res = 0;
+  else
+    *res = qs->i;
+  return 1;
+}
+
+// It moves the query to the leaf (or the children) of 'node'
+static int bwd_descend(rmMt* st, query_state* qs, long node) {
+  if(is_leaf(node, st)) {
+    long chunk = node - st->internal_nodes;
+    qs->node = node;
+    qs->phase = PH_LAST;
+    prefetch_chunk(st, chunk);
+    __builtin_prefetch(&st->e_prime[chunk]);
+  }
+  else {
+    qs->node = right_child(node);
+    qs->phase = PH_DOWN;
+    prefetch_node(st, qs->node - 1); // The left child is the previous position
+  }
+  return 0;
+}
+
+// It executes one step of a backward search. It returns 1 if the query is
+// finished (the answer is stored in 'res') and 0 otherwise
+static int bwd_step(rmMt* st, query_state* qs, int32_t* res) {
+  long chunk, node;
+  int32_t output;
+
+  switch(qs->phase) {
+  case PH_LEAF:
+    if(qs->only_match && bit_array_get_bit(st->bit_array, qs->i) == 1) {
+      *res = qs->i;
+      return 1;
+    }
+
+    // The answer is i itself (see bwd_search)
+    if(qs->d == 2*bit_array_get_bit(st->bit_array, qs->i)-1) {
+      *res = qs->i;
+      return 1;
+    }
+
+    qs->excess = sum(st, qs->i);
+    qs->target = qs->excess - qs->d;
+    output = check_leaf_l(st, qs->i, qs->excess + qs->d, qs->excess);
+    if(output < qs->i) {
+      *res = output;
+      return 1;
+    }
+
+    chunk = qs->i / st->s;
+    if(qs->only_match) {
+      qs->node = st->internal_nodes + chunk - 1;
+      qs->phase = PH_SCAN;
+      prefetch_node(st, qs->node);
+      if(chunk)
+	__builtin_prefetch(&st->e_prime[chunk-1]);
+      return 0;
+    }
+
+    if(chunk%2 == 1) { // The current chunk has a left sibling
+      qs->node = st->internal_nodes + chunk - 1;
+      qs->phase = PH_SIBLING;
+      prefetch_node(st, qs->node);
+      prefetch_chunk(st, chunk - 1);
+      __builtin_prefetch(&st->e_prime[chunk-1]);
+      return 0;
+    }
+
+    qs->node = parent(st->internal_nodes + chunk);
+    return bwd_climb(st, qs, res);
+
+  case PH_SIBLING:
+    chunk = qs->node - st->internal_nodes;
+    if(in_node(st, qs->node, qs->target)) {
+      output = check_sibling_l(st, st->s*chunk, qs->excess, qs->d);
+      if(output >= st->s*chunk) {
+	*res = output;
+	return 1;
+      }
+    }
+
+    qs->node = parent(qs->node);
+    return bwd_climb(st, qs, res);
+
+  case PH_SCAN:
+    chunk = max(qs->i / st->s - (long)st->scan_chunks, 0L);
+    for(node = qs->node; node >= st->internal_nodes + chunk; node--) {
+      // The answer is the first position of the next chunk
+      if(st->e_prime[node - st->internal_nodes] == qs->target) {
+	*res = (node - st->internal_nodes + 1)*st->s;
+	return 1;
+      }
+
+      if(in_node(st, node, qs->target))
+	return bwd_descend(st, qs, node);
+    }
+
+    // The excess value at position -1 is 0 (see bwd_search)
+    if(chunk == 0) {
+      *res = (qs->target == 0) ? 0 : qs->i;
+      return 1;
+    }
+
+    // Go up and down in the min-max tree from the last scanned leaf
+    qs->node = st->internal_nodes + chunk;
+    return bwd_climb(st, qs, res);
+
+  case PH_UP:
+    if(in_node(st, qs->node, qs->target))
+      return bwd_descend(st, qs, qs->node);
+
+    qs->node = parent(qs->node);
+    return bwd_climb(st, qs, res);
+
+  case PH_DOWN:
+    node = qs->node;
+    if(!in_node(st, node, qs->target)) {
+      node = left_sibling(node);
+      if(!in_node(st, node, qs->target)) {
+	*res = qs->i;
+	return 1;
+      }
+    }
+    return bwd_descend(st, qs, node);
+
+  case PH_LAST:
+  default:
+    chunk = qs->node - st->internal_nodes;
+    // Special case: the answer is at the beginning of the next chunk
+    if(st->e_prime[chunk] == qs->target)
+      *res = (chunk+1)*st->s;
+    else
+      *res = check_sibling_l(st, st->s*chunk, qs->excess, qs->d);
+    return 1;
+  }
+}
+
+/*
+ * Engine
+ */
+
+typedef int (*step_fn)(rmMt*, query_state*, int32_t*);
+
+static void run_batch(rmMt* st, const int32_t* I, int32_t d, int32_t* out,
+		      long q, unsigned int group, int only_match, step_fn step) {
+  if(group == 0)
+    group = 1;
+  if(group > BATCH_MAX_GROUP)
+    group = BATCH_MAX_GROUP;
+
+  // The states live in the stack of the caller, so concurrent batches do not
+  // share any scratch memory
+  query_state slots[group];
+  unsigned int active = 0, g = 0;
+  long next = 0;
+  int32_t res;
+
+  for(active = 0; active < group && next < q; active++)
+    init_query(st, &slots[active], I, d, next++, only_match);
+
+  while(active > 0) {
+    for(g = 0; g < active;) {
+      if(!step(st, &slots[g], &res)) {
+	g++;
+	continue;
+      }
+
+      out[slots[g].q] = res;
+      if(next < q) {
+	init_query(st, &slots[g], I, d, next++, only_match);
+	g++;
+      }
+      else // The slot is released and filled with the last active query
+	slots[g] = slots[--active];
+    }
+  }
+}
+
+void fwd_search_batch(rmMt* st, const int32_t* I, int32_t d, int32_t* out,
+		      long q, unsigned int group) {
+  run_batch(st, I, d, out, q, group, 0, fwd_step);
+}
+
+void bwd_search_batch(rmMt* st, const int32_t* I, int32_t d, int32_t* out,
+		      long q, unsigned int group) {
+  run_batch(st, I, d, out, q, group, 0, bwd_step);
+}
+
+void find_close_batch(rmMt* st, const int32_t* I, int32_t* out, long q,
+		      unsigned int group) {
+  run_batch(st, I, 0, out, q, group, 1, fwd_step);
+}
+
+void find_open_batch(rmMt* st, const int32_t* I, int32_t* out, long q,
+		     unsigned int group) {
+  run_batch(st, I, 0, out, q, group, 1, bwd_step);
+}
+
+/*
+ * Parallel execution
+ */
+
+static void run_block(rmMt* st, batch_op op, const int32_t* I, int32_t* out,
+		      long q, unsigned int group) {
+  long k;
+
+  switch(op) {
+  case BATCH_FIND_CLOSE:
+    find_close_batch(st, I, out, q, group);
+    break;
+  case BATCH_FIND_OPEN:
+    find_open_batch(st, I, out, q, group);
+    break;
+  case BATCH_DEPTH:
+    for(k = 0; k < q; k++)
+      out[k] = depth(st, I[k]);
+    break;
+  case BATCH_NEXT_SIBLING:
+    // next_sibling(i) = find_close(i)+1, if it is an opening parenthesis
+    find_close_batch(st, I, out, q, group);
+    for(k = 0; k < q; k++) {
+      if(I[k] >= st->n-1 || !bit_array_get_bit(st->bit_array, I[k]) ||
+	 out[k] >= st->n-1 || !bit_array_get_bit(st->bit_array, out[k]+1))
+	out[k] = -1;
+      else
+	out[k]++;
+    }
+    break;
+  }
+}
+
+void parallel_batch(rmMt* st, batch_op op, const int32_t* I, int32_t* out,
+		    long q, unsigned int group) {
+  long num_blocks = (q + BATCH_BLOCK - 1)/BATCH_BLOCK;
+
+  // Each block is processed by one worker. Blocks are multiples of the cache
+  // line size, so workers do not write to the same lines of 'out'
+  cilk_for(long block = 0; block < num_blocks; block++) {
+    long first = block*BATCH_BLOCK;
+    long len = (first + BATCH_BLOCK > q) ? q - first : BATCH_BLOCK;
+
+    run_block(st, op, I + first, out + first, len, group);
+  }
+}
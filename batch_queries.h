@@ -0,0 +1,85 @@
+
+/******************************************************************************
+ * batch_queries.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef BATCH_QUERIES_H
+#define BATCH_QUERIES_H
+
+#include "succinct_tree.h"
+
+/*
+ * Interleaved execution of batches of queries. Up to 'group' queries are kept
+ * in flight as small state machines. Every time a query needs a node of the
+ * min-max tree or a chunk of the bit array that is probably not in cache, it
+ * issues a prefetch and the engine switches to the next query of the group,
+ * hiding the latency of the dependent loads of fwd_search/bwd_search.
+ */
+
+// Default and maximal number of queries in flight
+#define BATCH_GROUP 16
+#define BATCH_MAX_GROUP 256
+
+// Number of consecutive queries processed by a worker of parallel_batch
+#define BATCH_BLOCK 4096
+
+// out[k] = fwd_search(st, I[k], d), for 0 <= k < q
+void fwd_search_batch(rmMt* st, const int32_t* I, int32_t d, int32_t* out,
+		      long q, unsigned int group);
+// out[k] = bwd_search(st, I[k], d), for 0 <= k < q
+void bwd_search_batch(rmMt* st, const int32_t* I, int32_t d, int32_t* out,
+		      long q, unsigned int group);
+
+// out[k] = find_close(st, I[k]), for 0 <= k < q. Like find_close and
+// find_open, they scan the next (previous) st->scan_chunks leaves of the
+// min-max tree before going up in it. They always walk the min-max tree,
+// even if the directory of pioneers (pioneer.h) is built
+void find_close_batch(rmMt* st, const int32_t* I, int32_t* out, long q,
+		      unsigned int group);
+// out[k] = find_open(st, I[k]), for 0 <= k < q
+void find_open_batch(rmMt* st, const int32_t* I, int32_t* out, long q,
+		     unsigned int group);
+
+/*
+ * Parallel execution of batches of read-only queries over a shared rmMt. The
+ * array of queries is split into blocks of BATCH_BLOCK queries that are
+ * distributed among the workers of the Cilk runtime. Each worker keeps its
+ * own in-flight queries (see above).
+ */
+
+typedef enum {
+  BATCH_FIND_CLOSE,
+  BATCH_FIND_OPEN,
+  BATCH_DEPTH,
+  BATCH_NEXT_SIBLING
+} batch_op;
+
+// out[k] = op(st, I[k]), for 0 <= k < q
+void parallel_batch(rmMt* st, batch_op op, const int32_t* I, int32_t* out,
+		    long q, unsigned int group);
+
+#endif // BATCH_QUERIES_H
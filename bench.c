@@ -0,0 +1,814 @@
+/******************************************************************************
+ * bench.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "succinct_tree.h"
+#include "batch_queries.h"
+#include "pioneer.h"
+#include "tree_iterator.h"
+#include "tree_arrays.h"
+#include "cartesian_tree.h"
+#include "louds.h"
+#include "dfuds.h"
+#include "dynamic_tree.h"
+#include "util.h"
+
+/*
+ * Query benchmarks. Each benchmark runs a set of random queries over the
+ * succinct tree built from the input parentheses sequence.
+ *
+ * Output: threads,input,n,benchmark,queries,parameter,time
+ */
+
+// Kind of positions used as queries
+enum { Q_OPEN, Q_CLOSE, Q_ANY };
+
+struct benchmark_t {
+  const char* name;
+  int kind;
+  void (*run)(rmMt* st, int32_t* Q, int32_t* out, long q, unsigned int param);
+  int leaves; // It requires the directory of leaves (st_create_leaves)
+  int array_rmq; // It requires the range minimum index of the queries
+  int louds; // It requires the LOUDS representation of the tree
+  int dfuds; // It requires the DFUDS representation of the tree
+  int dynamic; // It requires the dynamic tree (dyn_create)
+  int pioneers; // It requires the directory of pioneers (st_create_pioneers)
+};
+
+// Range minimum index of the array of queries (see run_rmq_array)
+static rmq_index* array_rmq;
+
+// LOUDS representation of the tree. The queries of its benchmarks are the
+// nodes Q[k]/2 in breadth-first order
+static louds_t* louds;
+
+// DFUDS representation of the tree. The queries of its benchmarks are
+// replaced by the positions of the nodes Q[k]/2 in preorder
+static dfuds_t* dfuds;
+
+// Dynamic tree built from the input sequence
+static dyn_tree* dyn;
+
+static void run_find_close(rmMt* st, int32_t* Q, int32_t* out, long q,
+			   unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = find_close(st, Q[k]);
+}
+
+static void run_find_close_tree(rmMt* st, int32_t* Q, int32_t* out, long q,
+				unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = find_close_tree(st, Q[k]);
+}
+
+// find_close scanning linearly up to 'param' leaves of the min-max tree
+static void run_find_close_scan(rmMt* st, int32_t* Q, int32_t* out, long q,
+				unsigned int param) {
+  st->scan_chunks = param;
+  for(long k = 0; k < q; k++)
+    out[k] = find_close(st, Q[k]);
+}
+
+static void run_find_close_batch(rmMt* st, int32_t* Q, int32_t* out, long q,
+				 unsigned int param) {
+  find_close_batch(st, Q, out, q, param);
+}
+
+static void run_find_open(rmMt* st, int32_t* Q, int32_t* out, long q,
+			  unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = find_open(st, Q[k]);
+}
+
+static void run_find_open_tree(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = find_open_tree(st, Q[k]);
+}
+
+// find_open scanning linearly up to 'param' leaves of the min-max tree
+static void run_find_open_scan(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  st->scan_chunks = param;
+  for(long k = 0; k < q; k++)
+    out[k] = find_open(st, Q[k]);
+}
+
+static void run_find_open_batch(rmMt* st, int32_t* Q, int32_t* out, long q,
+				unsigned int param) {
+  find_open_batch(st, Q, out, q, param);
+}
+
+static void run_find_close_par(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  parallel_batch(st, BATCH_FIND_CLOSE, Q, out, q, param);
+}
+
+static void run_find_open_par(rmMt* st, int32_t* Q, int32_t* out, long q,
+			      unsigned int param) {
+  parallel_batch(st, BATCH_FIND_OPEN, Q, out, q, param);
+}
+
+static void run_depth_par(rmMt* st, int32_t* Q, int32_t* out, long q,
+			  unsigned int param) {
+  parallel_batch(st, BATCH_DEPTH, Q, out, q, param);
+}
+
+static void run_next_sibling_par(rmMt* st, int32_t* Q, int32_t* out, long q,
+				 unsigned int param) {
+  parallel_batch(st, BATCH_NEXT_SIBLING, Q, out, q, param);
+}
+
+// Pairs of nodes (Q[k], Q[k+1])
+static void run_lca(rmMt* st, int32_t* Q, int32_t* out, long q,
+		    unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = lca(st, Q[k], Q[(k+1)%q]);
+}
+
+// Baseline: both nodes climb with parent_t until they meet
+static void run_lca_parent(rmMt* st, int32_t* Q, int32_t* out, long q,
+			   unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    int32_t i = Q[k], j = Q[(k+1)%q];
+    int32_t di = depth(st, i), dj = depth(st, j);
+
+    for(; di > dj; di--)
+      i = parent_t(st, i);
+    for(; dj > di; dj--)
+      j = parent_t(st, j);
+    while(i != j) {
+      i = parent_t(st, i);
+      j = parent_t(st, j);
+    }
+    out[k] = i;
+  }
+}
+
+static void run_distance(rmMt* st, int32_t* Q, int32_t* out, long q,
+			 unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = distance(st, Q[k], Q[(k+1)%q]);
+}
+
+// The parameter is the number of levels k
+static void run_level_ancestor(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = level_ancestor(st, Q[k], param);
+}
+
+// Baseline: k calls to parent_t
+static void run_level_ancestor_parent(rmMt* st, int32_t* Q, int32_t* out,
+				      long q, unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    int32_t i = Q[k];
+
+    if(depth(st, i) <= param) {
+      out[k] = -1;
+      continue;
+    }
+    for(unsigned int l = 0; l < param; l++)
+      i = parent_t(st, i);
+    out[k] = i;
+  }
+}
+
+static void run_level_next(rmMt* st, int32_t* Q, int32_t* out, long q,
+			   unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = level_next(st, Q[k]);
+}
+
+static void run_level_prev(rmMt* st, int32_t* Q, int32_t* out, long q,
+			   unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = level_prev(st, Q[k]);
+}
+
+static void run_subtree_size(rmMt* st, int32_t* Q, int32_t* out, long q,
+			     unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = subtree_size(st, Q[k]);
+}
+
+// Random positions in [0,n) are mapped to ranks in [1,n/2]
+static void run_preorder_select(rmMt* st, int32_t* Q, int32_t* out, long q,
+				unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = preorder_select(st, Q[k]/2+1);
+}
+
+static void run_postorder_select(rmMt* st, int32_t* Q, int32_t* out, long q,
+				 unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = postorder_select(st, Q[k]/2+1);
+}
+
+// The parameter is the rank t of the child of the parent of each query
+static void run_child(rmMt* st, int32_t* Q, int32_t* out, long q,
+		      unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = child(st, parent_t(st, Q[k]), param);
+}
+
+// Baseline: first_child and t-1 calls to next_sibling
+static void run_child_sibling(rmMt* st, int32_t* Q, int32_t* out, long q,
+			      unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    int32_t i = first_child(st, parent_t(st, Q[k]));
+
+    for(unsigned int t = 1; t < param && i >= 0; t++)
+      i = next_sibling(st, i);
+    out[k] = i;
+  }
+}
+
+// Enumeration of the whole list of siblings of each query node
+static void run_siblings(rmMt* st, int32_t* Q, int32_t* out, long q,
+			 unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    int32_t i = first_child(st, parent_t(st, Q[k]));
+    int32_t count = 0;
+
+    for(; i >= 0; i = next_sibling(st, i))
+      count++;
+    out[k] = count;
+  }
+}
+
+static void run_siblings_finger(rmMt* st, int32_t* Q, int32_t* out, long q,
+				unsigned int param) {
+  finger_t f;
+
+  for(long k = 0; k < q; k++) {
+    finger_init(st, &f, parent_t(st, Q[k]));
+    int32_t i = finger_first_child(st, &f);
+    int32_t count = 0;
+
+    for(; i >= 0; i = finger_next_sibling(st, &f))
+      count++;
+    out[k] = count;
+  }
+}
+
+static void run_degree(rmMt* st, int32_t* Q, int32_t* out, long q,
+		       unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = degree(st, parent_t(st, Q[k]));
+}
+
+static void run_leaf_rank(rmMt* st, int32_t* Q, int32_t* out, long q,
+			  unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = leaf_rank(st, Q[k]);
+}
+
+// Random positions are mapped to ranks of leaves
+static void run_leaf_select(rmMt* st, int32_t* Q, int32_t* out, long q,
+			    unsigned int param) {
+  int32_t leaves = st->l_prime[st->num_chunks-1];
+
+  for(long k = 0; k < q; k++)
+    out[k] = leaf_select(st, Q[k]%leaves+1);
+}
+
+static void run_leaf_count(rmMt* st, int32_t* Q, int32_t* out, long q,
+			   unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = leaf_count(st, Q[k]);
+}
+
+// Construction of the directory of leaves (the queries are not used)
+// Whole-tree traversals. They ignore the queries and store the sum of the
+// depths of the nodes in out[0]
+static void run_dfs(rmMt* st, int32_t* Q, int32_t* out, long q,
+		    unsigned int param) {
+  dfs_iterator it;
+  long total = 0;
+
+  dfs_init(st, &it);
+  while(dfs_next(&it))
+    total += it.depth;
+  out[0] = total;
+}
+
+static void run_dfs_navigation(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  long total = 0;
+  int32_t i = 0;
+
+  while(i >= 0) {
+    total += depth(st, i);
+
+    int32_t next = first_child(st, i);
+    // Go up until a node with a next sibling
+    while(next < 0) {
+      next = next_sibling(st, i);
+      if(next >= 0 || i == 0)
+	break;
+      i = parent_t(st, i);
+    }
+    i = next;
+  }
+  out[0] = total;
+}
+
+static void run_bfs(rmMt* st, int32_t* Q, int32_t* out, long q,
+		    unsigned int param) {
+  bfs_iterator it;
+  long total = 0;
+
+  bfs_init(st, &it);
+  while(bfs_next(&it))
+    total += it.depth;
+  out[0] = total;
+}
+
+// Bulk per-node arrays. They ignore the queries. The *_naive baselines call
+// depth and subtree_size for every node
+static void run_depth_array(rmMt* st, int32_t* Q, int32_t* out, long q,
+			    unsigned int param) {
+  free(st_depth_array(st));
+}
+
+static void run_depth_array_naive(rmMt* st, int32_t* Q, int32_t* out, long q,
+				  unsigned int param) {
+  int32_t* depths = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+  long pre = 0;
+
+  for(long i = 0; i < st->n; i++)
+    if(bit_array_get_bit(st->bit_array, i))
+      depths[pre++] = depth(st, i);
+  free(depths);
+}
+
+static void run_subtree_size_array(rmMt* st, int32_t* Q, int32_t* out, long q,
+				   unsigned int param) {
+  free(st_subtree_size_array(st));
+}
+
+static void run_subtree_size_array_naive(rmMt* st, int32_t* Q, int32_t* out,
+					 long q, unsigned int param) {
+  int32_t* sizes = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+  long pre = 0;
+
+  for(long i = 0; i < st->n; i++)
+    if(bit_array_get_bit(st->bit_array, i))
+      sizes[pre++] = subtree_size(st, i);
+  free(sizes);
+}
+
+static void run_parent_array(rmMt* st, int32_t* Q, int32_t* out, long q,
+			     unsigned int param) {
+  free(st_parent_array(st));
+}
+
+static void run_parent_array_naive(rmMt* st, int32_t* Q, int32_t* out, long q,
+				   unsigned int param) {
+  int32_t* parents = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+  long pre = 0;
+
+  for(long i = 0; i < st->n; i++)
+    if(bit_array_get_bit(st->bit_array, i))
+      parents[pre++] = i ? preorder_rank(st, parent_t(st, i)) - 1 : -1;
+  free(parents);
+}
+
+static void run_csr(rmMt* st, int32_t* Q, int32_t* out, long q,
+		    unsigned int param) {
+  free_csr(st_csr(st));
+}
+
+static void run_create_leaves(rmMt* st, int32_t* Q, int32_t* out, long q,
+			      unsigned int param) {
+  st_create_leaves(st);
+}
+
+static void run_subtree_height(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = subtree_height(st, Q[k]);
+}
+
+// Baseline: scan of the parentheses of the subtree
+static void run_subtree_height_scan(rmMt* st, int32_t* Q, int32_t* out,
+				    long q, unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    int32_t close = find_close(st, Q[k]), excess = 0, max = 0;
+
+    for(int32_t j = Q[k]; j <= close; j++) {
+      excess += 2*bit_array_get_bit(st->bit_array, j)-1;
+      if(excess > max)
+	max = excess;
+    }
+    out[k] = max-1;
+  }
+}
+
+static void run_parent(rmMt* st, int32_t* Q, int32_t* out, long q,
+		       unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = parent_t(st, Q[k]);
+}
+
+static void run_find_close_pioneer(rmMt* st, int32_t* Q, int32_t* out, long q,
+				   unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = pioneer_find_close(st, Q[k]);
+}
+
+static void run_find_open_pioneer(rmMt* st, int32_t* Q, int32_t* out, long q,
+				  unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = pioneer_find_open(st, Q[k]);
+}
+
+static void run_parent_pioneer(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = pioneer_enclose(st, Q[k]);
+}
+
+// Construction of the directory of pioneers (the queries are not used)
+static void run_create_pioneers(rmMt* st, int32_t* Q, int32_t* out, long q,
+				unsigned int param) {
+  st_create_pioneers(st);
+}
+
+// Construction of the range minimum index of the array of queries
+static void run_cartesian_tree(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  free_rmq_index(rmq_create_int(Q, q));
+}
+
+// Ranges [min(Q[k], Q[k+1]), max(Q[k], Q[k+1])] of the array of queries,
+// taken modulo q
+static void run_rmq_array(rmMt* st, int32_t* Q, int32_t* out, long q,
+			  unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    int32_t i = Q[k] % q, j = Q[(k+1)%q] % q;
+    out[k] = (i < j) ? rmq_array(array_rmq, i, j) : rmq_array(array_rmq, j, i);
+  }
+}
+
+static void run_st_to_louds(rmMt* st, int32_t* Q, int32_t* out, long q,
+			    unsigned int param) {
+  long n;
+  bit_array_free(st_to_louds(st, NULL, &n));
+}
+
+static void run_louds_parent(rmMt* st, int32_t* Q, int32_t* out, long q,
+			     unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = louds_parent(louds, Q[k]/2);
+}
+
+// The parameter is the rank t of the child of the parent of each query
+static void run_louds_child(rmMt* st, int32_t* Q, int32_t* out, long q,
+			    unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = louds_child(louds, louds_parent(louds, Q[k]/2), param);
+}
+
+static void run_louds_degree(rmMt* st, int32_t* Q, int32_t* out, long q,
+			     unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = louds_degree(louds, Q[k]/2);
+}
+
+static void run_st_to_dfuds(rmMt* st, int32_t* Q, int32_t* out, long q,
+			    unsigned int param) {
+  long n;
+  bit_array_free(st_to_dfuds(st, &n));
+}
+
+static void run_dfuds_parent(rmMt* st, int32_t* Q, int32_t* out, long q,
+			     unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = dfuds_parent(dfuds, Q[k]);
+}
+
+// The parameter is the rank t of the child of the parent of each query
+static void run_dfuds_child(rmMt* st, int32_t* Q, int32_t* out, long q,
+			    unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = dfuds_child(dfuds, dfuds_parent(dfuds, Q[k]), param);
+}
+
+static void run_dfuds_degree(rmMt* st, int32_t* Q, int32_t* out, long q,
+			     unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = dfuds_degree(dfuds, Q[k]);
+}
+
+static void run_dfuds_subtree_size(rmMt* st, int32_t* Q, int32_t* out,
+				   long q, unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = dfuds_subtree_size(dfuds, Q[k]);
+}
+
+static void run_dynamic_create(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  dyn_free(dyn_create(st->bit_array, st->n));
+}
+
+static void run_dynamic_find_close(rmMt* st, int32_t* Q, int32_t* out, long q,
+				   unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = dyn_find_close(dyn, Q[k]);
+}
+
+static void run_dynamic_parent(rmMt* st, int32_t* Q, int32_t* out, long q,
+			       unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = dyn_parent(dyn, Q[k]);
+}
+
+static void run_dynamic_lca(rmMt* st, int32_t* Q, int32_t* out, long q,
+			    unsigned int param) {
+  for(long k = 0; k < q; k++)
+    out[k] = dyn_lca(dyn, Q[k], Q[(k+1)%q]);
+}
+
+// Edit k of the update benchmarks. A leaf is inserted for an even k and a
+// node other than the root is deleted for an odd k, so the size of the tree
+// does not grow
+static void dynamic_edit(int32_t* Q, long k) {
+  if(k % 2 == 0) {
+    int32_t i = 1 + Q[k] % (dyn->n - 1);
+    insert_node(dyn, i, i+1);
+  }
+  else
+    delete_node(dyn, 1 + Q[k] % (dyn->n - 2));
+}
+
+static void run_insert_delete(rmMt* st, int32_t* Q, int32_t* out, long q,
+			      unsigned int param) {
+  for(long k = 0; k < q; k++)
+    dynamic_edit(Q, k);
+}
+
+// The same edits, with a static rmMt rebuilt every 'param' edits (never if
+// param is 0)
+static void run_rebuild_insert_delete(rmMt* st, int32_t* Q, int32_t* out,
+				      long q, unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    dynamic_edit(Q, k);
+    if(param && (k+1) % param == 0) {
+      long n;
+      BIT_ARRAY* B = dyn_to_bits(dyn, &n);
+      st_free(st_create(B, n));
+    }
+  }
+}
+
+// Construction of the rmMt from a copy of the input (baseline of the updates)
+static void run_st_create(rmMt* st, int32_t* Q, int32_t* out, long q,
+			  unsigned int param) {
+  st_free(st_create(bit_array_clone(st->bit_array), st->n));
+}
+
+static void assign_bit(BIT_ARRAY* B, long i, int bit) {
+  if(bit)
+    bit_array_set_bit(B, i);
+  else
+    bit_array_clear_bit(B, i);
+}
+
+// Balanced rewrites: the subtree of each query is mirrored in place if it
+// spans at most 'param' chunks
+static void run_update_range(rmMt* st, int32_t* Q, int32_t* out, long q,
+			     unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    int32_t i = Q[k], j = find_close(st, i);
+    if(j - i >= param*st->s)
+      continue;
+
+    for(int32_t l = i, r = j; l < r; l++, r--) {
+      int bl = bit_array_get_bit(st->bit_array, l);
+      int br = bit_array_get_bit(st->bit_array, r);
+      assign_bit(st->bit_array, l, !br);
+      assign_bit(st->bit_array, r, !bl);
+    }
+    st_update_range(st, i, j);
+  }
+}
+
+// Unbalanced rewrites of one bit, with the shifts applied at the end
+static void run_update_range_shift(rmMt* st, int32_t* Q, int32_t* out, long q,
+				   unsigned int param) {
+  for(long k = 0; k < q; k++) {
+    assign_bit(st->bit_array, Q[k], !bit_array_get_bit(st->bit_array, Q[k]));
+    st_update_range(st, Q[k], Q[k]);
+  }
+  st_flush_updates(st);
+}
+
+static struct benchmark_t benchmarks[] = {
+  {"find_close", Q_OPEN, run_find_close},
+  {"find_close_tree", Q_OPEN, run_find_close_tree},
+  {"find_close_scan", Q_OPEN, run_find_close_scan},
+  {"find_close_batch", Q_OPEN, run_find_close_batch},
+  {"find_open", Q_CLOSE, run_find_open},
+  {"find_open_tree", Q_CLOSE, run_find_open_tree},
+  {"find_open_scan", Q_CLOSE, run_find_open_scan},
+  {"find_open_batch", Q_CLOSE, run_find_open_batch},
+  {"find_close_par", Q_OPEN, run_find_close_par},
+  {"find_open_par", Q_CLOSE, run_find_open_par},
+  {"depth_par", Q_OPEN, run_depth_par},
+  {"next_sibling_par", Q_OPEN, run_next_sibling_par},
+  {"lca", Q_OPEN, run_lca},
+  {"lca_parent", Q_OPEN, run_lca_parent},
+  {"distance", Q_OPEN, run_distance},
+  {"level_ancestor", Q_OPEN, run_level_ancestor},
+  {"level_ancestor_parent", Q_OPEN, run_level_ancestor_parent},
+  {"level_next", Q_OPEN, run_level_next},
+  {"level_prev", Q_OPEN, run_level_prev},
+  {"subtree_size", Q_OPEN, run_subtree_size},
+  {"preorder_select", Q_ANY, run_preorder_select},
+  {"postorder_select", Q_ANY, run_postorder_select},
+  {"child", Q_OPEN, run_child},
+  {"child_sibling", Q_OPEN, run_child_sibling},
+  {"degree", Q_OPEN, run_degree},
+  {"siblings", Q_OPEN, run_siblings},
+  {"siblings_finger", Q_OPEN, run_siblings_finger},
+  {"leaf_rank", Q_ANY, run_leaf_rank, 1},
+  {"leaf_select", Q_ANY, run_leaf_select, 1},
+  {"leaf_count", Q_OPEN, run_leaf_count, 1},
+  {"create_leaves", Q_ANY, run_create_leaves},
+  {"dfs", Q_ANY, run_dfs},
+  {"dfs_navigation", Q_ANY, run_dfs_navigation},
+  {"bfs", Q_ANY, run_bfs},
+  {"depth_array", Q_ANY, run_depth_array},
+  {"depth_array_naive", Q_ANY, run_depth_array_naive},
+  {"subtree_size_array", Q_ANY, run_subtree_size_array},
+  {"subtree_size_array_naive", Q_ANY, run_subtree_size_array_naive},
+  {"parent_array", Q_ANY, run_parent_array},
+  {"parent_array_naive", Q_ANY, run_parent_array_naive},
+  {"csr", Q_ANY, run_csr},
+  {"subtree_height", Q_OPEN, run_subtree_height},
+  {"subtree_height_scan", Q_OPEN, run_subtree_height_scan},
+  {"parent", Q_OPEN, run_parent},
+  {"find_close_pioneer", Q_OPEN, run_find_close_pioneer, 0, 0, 0, 0, 0, 1},
+  {"find_open_pioneer", Q_CLOSE, run_find_open_pioneer, 0, 0, 0, 0, 0, 1},
+  {"parent_pioneer", Q_OPEN, run_parent_pioneer, 0, 0, 0, 0, 0, 1},
+  {"create_pioneers", Q_ANY, run_create_pioneers},
+  {"cartesian_tree", Q_ANY, run_cartesian_tree},
+  {"rmq_array", Q_ANY, run_rmq_array, 0, 1},
+  {"st_to_louds", Q_ANY, run_st_to_louds},
+  {"louds_parent", Q_ANY, run_louds_parent, 0, 0, 1},
+  {"louds_child", Q_ANY, run_louds_child, 0, 0, 1},
+  {"louds_degree", Q_ANY, run_louds_degree, 0, 0, 1},
+  {"st_to_dfuds", Q_ANY, run_st_to_dfuds},
+  {"dfuds_parent", Q_ANY, run_dfuds_parent, 0, 0, 0, 1},
+  {"dfuds_child", Q_ANY, run_dfuds_child, 0, 0, 0, 1},
+  {"dfuds_degree", Q_ANY, run_dfuds_degree, 0, 0, 0, 1},
+  {"dfuds_subtree_size", Q_ANY, run_dfuds_subtree_size, 0, 0, 0, 1},
+  {"dynamic_create", Q_ANY, run_dynamic_create},
+  {"dynamic_find_close", Q_OPEN, run_dynamic_find_close, 0, 0, 0, 0, 1},
+  {"dynamic_parent", Q_OPEN, run_dynamic_parent, 0, 0, 0, 0, 1},
+  {"dynamic_lca", Q_OPEN, run_dynamic_lca, 0, 0, 0, 0, 1},
+  {"insert_delete", Q_ANY, run_insert_delete, 0, 0, 0, 0, 1},
+  {"rebuild_insert_delete", Q_ANY, run_rebuild_insert_delete,
+   0, 0, 0, 0, 1},
+  {"st_create", Q_ANY, run_st_create},
+  {"update_range", Q_OPEN, run_update_range},
+  {"update_range_shift", Q_ANY, run_update_range_shift},
+  {NULL, 0, NULL}
+};
+
+static int32_t* random_queries(rmMt* st, long q, int kind) {
+  int32_t* Q = (int32_t*)malloc(q*sizeof(int32_t));
+  unsigned int seed = 42;
+
+  for(long k = 0; k < q; k++) {
+    int32_t i;
+    do {
+      i = ((unsigned long)rand_r(&seed) * (RAND_MAX + 1UL) +
+	   rand_r(&seed)) % st->n;
+    } while(kind != Q_ANY && bit_array_get_bit(st->bit_array, i) != (kind == Q_OPEN));
+    Q[k] = i;
+  }
+
+  return Q;
+}
+
+static void usage(char* name) {
+  fprintf(stderr, "Usage: %s <input parentheses sequence> <benchmark> "
+	  "[queries] [parameter]\n", name);
+  fprintf(stderr, "Benchmarks:");
+  for(int b = 0; benchmarks[b].name; b++)
+    fprintf(stderr, " %s", benchmarks[b].name);
+  fprintf(stderr, "\n");
+  exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+
+  struct timespec stime, etime;
+  double time;
+
+  if(argc < 3)
+    usage(argv[0]);
+
+  struct benchmark_t* bench = NULL;
+  for(int b = 0; benchmarks[b].name; b++)
+    if(!strcmp(benchmarks[b].name, argv[2]))
+      bench = &benchmarks[b];
+  if(!bench)
+    usage(argv[0]);
+
+  long q = (argc > 3) ? atol(argv[3]) : 1000000;
+  unsigned int param = (argc > 4) ? atoi(argv[4]) : BATCH_GROUP;
+
+  long n;
+  BIT_ARRAY *B = parentheses_to_bits(argv[1], &n);
+  rmMt *st = st_create(B, n);
+  fprintf(stderr, "scan_chunks: %u\n", st_calibrate(st));
+  if(bench->leaves)
+    st_create_leaves(st);
+  if(bench->pioneers && !st->pioneers)
+    st_create_pioneers(st);
+  if(st->pioneers)
+    fprintf(stderr, "rmMt: %lu bytes, pioneers: %lu bytes\n", size_rmMt(st),
+	    size_pioneers(st));
+
+  int32_t* Q = random_queries(st, q, bench->kind);
+  int32_t* out = (int32_t*)malloc(q*sizeof(int32_t));
+  if(bench->array_rmq)
+    array_rmq = rmq_create_int(Q, q);
+  if(bench->louds) {
+    long louds_n;
+    BIT_ARRAY* L = st_to_louds(st, NULL, &louds_n);
+    louds = louds_create(L, louds_n);
+  }
+  if(bench->dfuds) {
+    long dfuds_n;
+    BIT_ARRAY* D = st_to_dfuds(st, &dfuds_n);
+    dfuds = dfuds_create(D, dfuds_n);
+    for(long k = 0; k < q; k++)
+      Q[k] = dfuds_select(dfuds, Q[k]/2);
+  }
+  if(bench->dynamic)
+    dyn = dyn_create(st->bit_array, st->n);
+
+  if (clock_gettime(CLOCK_MONOTONIC, &stime)) {
+    fprintf(stderr, "clock_gettime failed");
+    exit(-1);
+  }
+
+  bench->run(st, Q, out, q, param);
+
+  if (clock_gettime(CLOCK_MONOTONIC, &etime)) {
+    fprintf(stderr, "clock_gettime failed");
+    exit(-1);
+  }
+
+  time = (etime.tv_sec - stime.tv_sec) + (etime.tv_nsec - stime.tv_nsec) / 1000000000.0;
+  printf("%d,%s,%lu,%s,%ld,%u,%lf\n", threads, argv[1], n, bench->name, q,
+	 param, time);
+
+  if(array_rmq)
+    free_rmq_index(array_rmq);
+  if(louds)
+    free_louds(louds);
+  if(dfuds)
+    free_dfuds(dfuds);
+  if(dyn)
+    dyn_free(dyn);
+  free(Q);
+  free(out);
+
+  return EXIT_SUCCESS;
+}
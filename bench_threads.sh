@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# Throughput of the parallel batch queries as a function of the number of
+# threads
+# Usage: bash bench_threads.sh <input parentheses sequence> [queries] [max threads]
+
+INPUT=$1
+QUERIES=${2:-10000000}
+MAX_THREADS=${3:-$(nproc)}
+
+for BENCH in find_close_par depth_par next_sibling_par; do
+    T=1
+    while [ $T -le $MAX_THREADS ]; do
+	CILK_NWORKERS=$T ./st_bench_par $INPUT $BENCH $QUERIES
+	T=$((T*2))
+    done
+done
@@ -0,0 +1,1202 @@
+
+/******************************************************************************
+ * bp_input.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bp_input.h"
+#include "util.h"
+#include "basic.h"
+
+/*
+ * The sequence is the Euler tour of the tree: the token 2v is the opening
+ * parenthesis of the node v and the token 2v+1 is its closing parenthesis.
+ * The position of each token in the tour is computed by sublist ranking:
+ * the tour is cut at splitter tokens, each sublist is walked in parallel to
+ * obtain its length, the splitters are ranked sequentially and then each
+ * sublist is walked again, writing its parentheses at their final positions.
+ */
+
+// Number of sublists per thread
+#define SUBLISTS 64
+
+struct tour_t {
+  long nodes;
+  int32_t root;
+  const int32_t* parents;
+  // Order of the siblings. If keys is NULL the children are sorted by
+  // identifier, otherwise by keys[v], the position of the edge (p, v) in
+  // the edge list 'edges'
+  const int32_t* keys;
+  const int32_t* edges;
+  // Token that follows each token in the tour, or -1 at the end. The two
+  // tokens of a node are contiguous, so each step of a walk touches a single
+  // cache line
+  long* succ;
+};
+
+static int compare_int32(const void* a, const void* b) {
+  int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+  return (x > y) - (x < y);
+}
+
+// It computes the successor of each token of the tour, from the children
+// lists of the tree sorted by identifier or by key
+static void build_successors(struct tour_t* tour) {
+  long nodes = tour->nodes;
+  const int32_t* parents = tour->parents;
+  int32_t* offsets = (int32_t*)calloc(nodes+1, sizeof(int32_t));
+  int32_t* children = (int32_t*)malloc(max(nodes-1, 1)*sizeof(int32_t));
+  int32_t* fill = (int32_t*)malloc(nodes*sizeof(int32_t));
+
+  // Number of children of each node, stored in offsets[p+1]
+  cilk_for(long v = 0; v < nodes; v++)
+    if(parents[v] >= 0)
+      __sync_fetch_and_add(&offsets[parents[v]+1], 1);
+
+  // Prefix sum of the number of children
+  prefix_sum_32(offsets+1, nodes);
+
+  // Each node (or its key) is placed in the list of its parent. The free
+  // position of each list is kept in fill[p], and the lists are sorted
+  // afterwards
+  const int32_t* keys = tour->keys;
+  cilk_for(long v = 0; v < nodes; v++)
+    fill[v] = offsets[v];
+  cilk_for(long v = 0; v < nodes; v++)
+    if(parents[v] >= 0)
+      children[__sync_fetch_and_add(&fill[parents[v]], 1)] = keys ? keys[v] : v;
+  free(fill);
+
+  cilk_for(long v = 0; v < nodes; v++)
+    if(offsets[v+1] - offsets[v] > 1)
+      qsort(children + offsets[v], offsets[v+1] - offsets[v], sizeof(int32_t),
+	    compare_int32);
+
+  if(keys)
+    cilk_for(long k = 0; k < nodes-1; k++)
+      children[k] = tour->edges[2L*children[k]+1];
+
+  // Opening parenthesis: first child or closing parenthesis. Closing
+  // parenthesis: next sibling or closing parenthesis of the parent
+  long* succ = (long*)malloc(2*nodes*sizeof(long));
+  cilk_for(long v = 0; v < nodes; v++) {
+    succ[2*v] = (offsets[v] < offsets[v+1]) ? 2L*children[offsets[v]] : 2*v+1;
+    for(long k = offsets[v]; k < offsets[v+1]; k++)
+      succ[2L*children[k]+1] = (k+1 < offsets[v+1]) ? 2L*children[k+1] : 2*v+1;
+  }
+  succ[2L*tour->root+1] = -1;
+
+  free(offsets);
+  free(children);
+
+  tour->succ = succ;
+}
+
+// It writes the bit of the opening parentheses of a sublist. Words that are
+// not completely covered by the sublist may be shared with other sublists
+static inline void flush_word(BIT_ARRAY* B, long w, word_t bits, long first,
+			      long last) {
+  if(!bits)
+    return;
+
+  if((w << logW) >= first && ((w+1) << logW) <= last)
+    B->words[w] = bits;
+  else
+    __sync_fetch_and_or(&B->words[w], bits);
+}
+
+// It returns the balanced parentheses sequence of the tree. The fields
+// nodes, parents, keys and edges of the tour must be initialized
+static BIT_ARRAY* tour_to_bits(struct tour_t* tour_in, long* n) {
+  struct tour_t tour = *tour_in;
+  const int32_t* parents = tour.parents;
+  long nodes = tour.nodes;
+  tour.root = -1;
+
+  for(long v = 0; v < nodes; v++) {
+    if(parents[v] < -1 || parents[v] >= nodes) {
+      fprintf(stderr, "Error: invalid parent of node %ld (%d)\n", v, parents[v]);
+      exit(EXIT_FAILURE);
+    }
+    if(parents[v] == -1) {
+      if(tour.root >= 0) {
+	fprintf(stderr, "Error: nodes %d and %ld are both roots\n", tour.root, v);
+	exit(EXIT_FAILURE);
+      }
+      tour.root = v;
+    }
+  }
+  if(tour.root < 0) {
+    fprintf(stderr, "Error: the tree has no root\n");
+    exit(EXIT_FAILURE);
+  }
+
+  build_successors(&tour);
+
+  *n = 2*nodes;
+  BIT_ARRAY* B = bit_array_create(*n);
+
+  // Splitters: the opening parenthesis of the root (sublist 'sublists') and
+  // the tokens multiple of 'stride'
+  long sublists = (long)threads*SUBLISTS;
+  long stride = max(1, (*n + sublists - 1)/sublists);
+  sublists = (*n + stride - 1)/stride;
+  long root_token = 2L*tour.root;
+  long* length = (long*)calloc(sublists+1, sizeof(long));
+  long* next = (long*)malloc((sublists+1)*sizeof(long));
+  long* start = (long*)malloc((sublists+1)*sizeof(long));
+
+#define SUBLIST_HEAD(s) ((s) == sublists ? root_token : (s)*stride)
+#define IS_SPLITTER(t) ((t) % stride == 0 || (t) == root_token)
+#define SUBLIST_OF(t) ((t) == root_token ? sublists : (t)/stride)
+
+  // Length of each sublist and its next sublist
+  cilk_for(long s = 0; s <= sublists; s++) {
+    long t = SUBLIST_HEAD(s);
+
+    if(s == sublists || t != root_token) {
+      long len = 0;
+      do {
+	if(++len > *n) { // A cycle
+	  fprintf(stderr, "Error: the input is not a tree\n");
+	  exit(EXIT_FAILURE);
+	}
+	t = tour.succ[t];
+      } while(t >= 0 && !IS_SPLITTER(t));
+
+      length[s] = len;
+      next[s] = (t < 0) ? -1 : SUBLIST_OF(t);
+    }
+  }
+
+  // Ranking of the sublists, following the tour from the root
+  long position = 0;
+  for(long s = sublists; s >= 0; s = next[s]) {
+    start[s] = position;
+    position += length[s];
+  }
+  if(position != *n) {
+    fprintf(stderr, "Error: the input is not a tree\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Each sublist writes its opening parentheses
+  cilk_for(long s = 0; s <= sublists; s++) {
+    long t = SUBLIST_HEAD(s);
+
+    if(s == sublists || t != root_token) {
+      long first = start[s], last = start[s] + length[s];
+      long w = first >> logW;
+      word_t bits = 0;
+
+      for(long i = first; i < last; i++) {
+	if((i >> logW) != w) {
+	  flush_word(B, w, bits, first, last);
+	  w = i >> logW;
+	  bits = 0;
+	}
+	if((t & 1) == 0)
+	  bits |= (word_t)1 << (i & (word_size-1));
+	t = tour.succ[t];
+      }
+      flush_word(B, w, bits, first, last);
+    }
+  }
+
+#undef SUBLIST_HEAD
+#undef IS_SPLITTER
+#undef SUBLIST_OF
+
+  free(length);
+  free(next);
+  free(start);
+  free(tour.succ);
+
+  return B;
+}
+
+BIT_ARRAY* parents_to_bits(const int32_t* parents, long nodes, long* n) {
+  struct tour_t tour;
+  tour.nodes = nodes;
+  tour.parents = parents;
+  tour.keys = NULL;
+  tour.edges = NULL;
+
+  return tour_to_bits(&tour, n);
+}
+
+BIT_ARRAY* edges_to_bits(const int32_t* edges, long m, edge_order order,
+			 long* n) {
+  long nodes = m+1;
+  int32_t* parents = (int32_t*)malloc(nodes*sizeof(int32_t));
+  int32_t* keys = NULL;
+
+  cilk_for(long v = 0; v < nodes; v++)
+    parents[v] = -1;
+
+  // Each node is the child of at most one edge. Nodes without a parent are
+  // checked by tour_to_bits (there must be exactly one)
+  cilk_for(long e = 0; e < m; e++) {
+    int32_t p = edges[2*e], c = edges[2*e+1];
+    if(p < 0 || p >= nodes || c < 0 || c >= nodes) {
+      fprintf(stderr, "Error: invalid edge %ld (%d, %d), the identifiers must "
+	      "be in [0, %ld]\n", e, p, c, m);
+      exit(EXIT_FAILURE);
+    }
+    if(!__sync_bool_compare_and_swap(&parents[c], -1, p)) {
+      fprintf(stderr, "Error: node %d has more than one parent\n", c);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if(order == EDGE_ORDER_INPUT) {
+    keys = (int32_t*)malloc(nodes*sizeof(int32_t));
+    cilk_for(long e = 0; e < m; e++)
+      keys[edges[2*e+1]] = e;
+  }
+
+  struct tour_t tour;
+  tour.nodes = nodes;
+  tour.parents = parents;
+  tour.keys = keys;
+  tour.edges = edges;
+
+  BIT_ARRAY* B = tour_to_bits(&tour, n);
+
+  free(parents);
+  free(keys);
+
+  return B;
+}
+
+// It reads a binary file of 32-bit integers
+static int32_t* read_integers(const char* fn, long* m) {
+  FILE* fp = fopen(fn, "r");
+  if (!fp) {
+    fprintf(stderr, "Error opening file \"%s\".\n", fn);
+    exit(-1);
+  }
+
+  fseek(fp, 0L, SEEK_END);
+  *m = ftell(fp)/sizeof(int32_t);
+  fseek(fp, 0L, SEEK_SET);
+
+  int32_t* A = (int32_t*)malloc(*m*sizeof(int32_t));
+  if(fread(A, sizeof(int32_t), *m, fp) != *m) {
+    fprintf(stderr, "Error reading file \"%s\".\n", fn);
+    exit(-1);
+  }
+
+  fclose(fp);
+
+  return A;
+}
+
+int32_t* read_parent_array(const char* fn, long* nodes) {
+  return read_integers(fn, nodes);
+}
+
+int32_t* read_lcp_array(const char* fn, long* n) {
+  return read_integers(fn, n);
+}
+
+// It returns the number of integers in text[first..last-1]. Lines starting
+// with '#' are comments. If out is not NULL the integers are stored in out
+static long parse_integers(const char* text, long first, long last,
+			   int32_t* out) {
+  long count = 0, i = first;
+
+  while(i < last) {
+    char c = text[i];
+    if(c == '#' && (i == 0 || text[i-1] == '\n')) {
+      while(i < last && text[i] != '\n')
+	i++;
+    }
+    else if(c >= '0' && c <= '9') {
+      long value = 0;
+      while(i < last && text[i] >= '0' && text[i] <= '9')
+	if((value = 10*value + (text[i++] - '0')) > INT32_MAX) {
+	  fprintf(stderr, "Error: identifier out of range in the edge list\n");
+	  exit(EXIT_FAILURE);
+	}
+      if(out)
+	out[count] = value;
+      count++;
+    }
+    else if(c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',')
+      i++;
+    else {
+      fprintf(stderr, "Error: unexpected character '%c' in the edge list\n", c);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  return count;
+}
+
+int32_t* read_edge_list(const char* fn, long* m) {
+  FILE* fp = fopen(fn, "r");
+  if (!fp) {
+    fprintf(stderr, "Error opening file \"%s\".\n", fn);
+    exit(-1);
+  }
+
+  fseek(fp, 0L, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0L, SEEK_SET);
+
+  char* text = (char*)malloc(size+1);
+  if(fread(text, sizeof(char), size, fp) != size) {
+    fprintf(stderr, "Error reading file \"%s\".\n", fn);
+    exit(-1);
+  }
+  fclose(fp);
+
+  // The text is split into chunks that start after a newline, so no chunk
+  // starts in the middle of an integer or of a comment
+  unsigned int chunks = (size < 4096*threads) ? 1 : threads;
+  long* bounds = (long*)malloc((chunks+1)*sizeof(long));
+  long* counts = (long*)malloc((chunks+1)*sizeof(long));
+
+  bounds[0] = 0;
+  bounds[chunks] = size;
+  cilk_for(unsigned int k = 1; k < chunks; k++) {
+    long i = k*(size/chunks);
+    while(i < size && text[i-1] != '\n')
+      i++;
+    bounds[k] = i;
+  }
+  for(unsigned int k = 1; k < chunks; k++) // A chunk may be empty
+    bounds[k] = max(bounds[k], bounds[k-1]);
+
+  cilk_for(unsigned int k = 0; k < chunks; k++)
+    counts[k] = parse_integers(text, bounds[k], bounds[k+1], NULL);
+
+  long total = 0;
+  for(unsigned int k = 0; k < chunks; k++) {
+    long c = counts[k];
+    counts[k] = total;
+    total += c;
+  }
+
+  if(total % 2) {
+    fprintf(stderr, "Error: the edge list \"%s\" has an odd number of "
+	    "identifiers\n", fn);
+    exit(EXIT_FAILURE);
+  }
+
+  int32_t* edges = (int32_t*)malloc(max(total, 1)*sizeof(int32_t));
+  cilk_for(unsigned int k = 0; k < chunks; k++)
+    parse_integers(text, bounds[k], bounds[k+1], edges + counts[k]);
+
+  free(text);
+  free(bounds);
+  free(counts);
+
+  *m = total/2;
+
+  return edges;
+}
+
+/*
+ * The structure of XML and JSON documents is recognized by a deterministic
+ * automaton whose transitions may emit a parenthesis. The file is split into
+ * chunks that are parsed in parallel. The state at the beginning of a chunk
+ * is unknown, so each chunk starts at a split point where only a few states
+ * are possible (the candidates) and the chunk is parsed once for each
+ * candidate. Sequentially, the candidate of each chunk that matches the final
+ * state of the previous chunk is chosen (if no candidate matches, the chunk
+ * is parsed again from the right state) and the number of parentheses and the
+ * excess of the chunks give the position and the excess where each chunk
+ * starts, as in st_create. A last parallel pass writes the parentheses.
+ */
+
+// Maximal number of states of the automata and of candidate states
+#define DOC_STATES 64
+#define DOC_CANDIDATES 2
+
+// A transition is the next state plus the emitted parenthesis
+#define DOC_OPEN (1 << 6)
+#define DOC_CLOSE (2 << 6)
+#define DOC_STATE(x) ((x) & (DOC_STATES-1))
+
+struct doc_dfa {
+  unsigned char delta[DOC_STATES][256];
+  int initial; // State at the beginning of the document
+  int candidates[DOC_CANDIDATES]; // Possible states at a split point
+  int num_candidates;
+  // It returns the first split point in text[i..size-1], or size
+  long (*split)(const char* text, long i, long size);
+  int num_exits[DOC_STATES]; // See doc_exits
+  unsigned char exit[DOC_STATES];
+};
+
+// Result of parsing a chunk from a given state
+struct doc_run {
+  int end; // Final state
+  long count; // Number of parentheses
+  long excess; // Excess at the end
+  long min_excess; // Minimum excess, 0 if it is never negative
+};
+
+struct doc_chunk {
+  long first, last;
+  int start; // Resolved state at the beginning of the chunk
+  long position; // Position of the first parenthesis of the chunk
+  struct doc_run runs[DOC_CANDIDATES];
+};
+
+// It sets the transitions of the state s on every symbol to 'to'
+static void doc_row(struct doc_dfa* dfa, int s, int to) {
+  for(int c = 0; c < 256; c++)
+    dfa->delta[s][c] = to;
+}
+
+// XML: only the elements are nodes. Comments, CDATA sections, processing
+// instructions and declarations are skipped, and '<' is not allowed in text
+// or in attribute values, so a split point is a '<' in the text state
+enum { X_TEXT, X_LT, X_START, X_SLASH, X_DQ, X_SQ, X_END, X_PI, X_PI_Q,
+       X_BANG, X_BANG_DASH, X_COMMENT, X_COMMENT_D1, X_COMMENT_D2, X_CDATA_HDR,
+       X_CDATA, X_CDATA_B1, X_CDATA_B2, X_DECL, X_DECL_SUBSET };
+
+static long xml_split(const char* text, long i, long size) {
+  const char* lt = memchr(text+i, '<', size-i);
+  return lt ? lt-text : size;
+}
+
+static void xml_dfa(struct doc_dfa* dfa) {
+  doc_row(dfa, X_TEXT, X_TEXT);
+  dfa->delta[X_TEXT]['<'] = X_LT;
+
+  doc_row(dfa, X_LT, X_START | DOC_OPEN); // Start tag
+  dfa->delta[X_LT]['/'] = X_END | DOC_CLOSE; // End tag
+  dfa->delta[X_LT]['?'] = X_PI;
+  dfa->delta[X_LT]['!'] = X_BANG;
+
+  doc_row(dfa, X_START, X_START);
+  dfa->delta[X_START]['"'] = X_DQ;
+  dfa->delta[X_START]['\''] = X_SQ;
+  dfa->delta[X_START]['/'] = X_SLASH;
+  dfa->delta[X_START]['>'] = X_TEXT;
+
+  for(int c = 0; c < 256; c++) // Empty-element tag if it is followed by '>'
+    dfa->delta[X_SLASH][c] = dfa->delta[X_START][c];
+  dfa->delta[X_SLASH]['>'] = X_TEXT | DOC_CLOSE;
+
+  doc_row(dfa, X_DQ, X_DQ);
+  dfa->delta[X_DQ]['"'] = X_START;
+  doc_row(dfa, X_SQ, X_SQ);
+  dfa->delta[X_SQ]['\''] = X_START;
+
+  doc_row(dfa, X_END, X_END);
+  dfa->delta[X_END]['>'] = X_TEXT;
+
+  doc_row(dfa, X_PI, X_PI);
+  dfa->delta[X_PI]['?'] = X_PI_Q;
+  doc_row(dfa, X_PI_Q, X_PI);
+  dfa->delta[X_PI_Q]['?'] = X_PI_Q;
+  dfa->delta[X_PI_Q]['>'] = X_TEXT;
+
+  doc_row(dfa, X_BANG, X_DECL);
+  dfa->delta[X_BANG]['-'] = X_BANG_DASH;
+  dfa->delta[X_BANG]['['] = X_CDATA_HDR;
+  dfa->delta[X_BANG]['>'] = X_TEXT;
+  doc_row(dfa, X_BANG_DASH, X_DECL);
+  dfa->delta[X_BANG_DASH]['-'] = X_COMMENT;
+
+  doc_row(dfa, X_COMMENT, X_COMMENT);
+  dfa->delta[X_COMMENT]['-'] = X_COMMENT_D1;
+  doc_row(dfa, X_COMMENT_D1, X_COMMENT);
+  dfa->delta[X_COMMENT_D1]['-'] = X_COMMENT_D2;
+  doc_row(dfa, X_COMMENT_D2, X_COMMENT);
+  dfa->delta[X_COMMENT_D2]['-'] = X_COMMENT_D2;
+  dfa->delta[X_COMMENT_D2]['>'] = X_TEXT;
+
+  doc_row(dfa, X_CDATA_HDR, X_CDATA_HDR); // "<![CDATA["
+  dfa->delta[X_CDATA_HDR]['['] = X_CDATA;
+  doc_row(dfa, X_CDATA, X_CDATA);
+  dfa->delta[X_CDATA][']'] = X_CDATA_B1;
+  doc_row(dfa, X_CDATA_B1, X_CDATA);
+  dfa->delta[X_CDATA_B1][']'] = X_CDATA_B2;
+  doc_row(dfa, X_CDATA_B2, X_CDATA);
+  dfa->delta[X_CDATA_B2][']'] = X_CDATA_B2;
+  dfa->delta[X_CDATA_B2]['>'] = X_TEXT;
+
+  doc_row(dfa, X_DECL, X_DECL); // <!DOCTYPE ...> with its internal subset
+  dfa->delta[X_DECL]['['] = X_DECL_SUBSET;
+  dfa->delta[X_DECL]['>'] = X_TEXT;
+  doc_row(dfa, X_DECL_SUBSET, X_DECL_SUBSET);
+  dfa->delta[X_DECL_SUBSET][']'] = X_DECL;
+
+  dfa->initial = X_TEXT;
+  dfa->candidates[0] = X_TEXT;
+  dfa->num_candidates = 1;
+  dfa->split = xml_split;
+}
+
+// JSON: only the objects and the arrays are nodes. A split point is a
+// symbol that does not follow a backslash, so it is either inside or outside
+// a string
+enum { J_OUT, J_STRING, J_ESCAPE };
+
+static long json_split(const char* text, long i, long size) {
+  while(i < size && text[i-1] == '\\')
+    i++;
+  return i;
+}
+
+static void json_dfa(struct doc_dfa* dfa) {
+  doc_row(dfa, J_OUT, J_OUT);
+  dfa->delta[J_OUT]['"'] = J_STRING;
+  dfa->delta[J_OUT]['{'] = dfa->delta[J_OUT]['['] = J_OUT | DOC_OPEN;
+  dfa->delta[J_OUT]['}'] = dfa->delta[J_OUT][']'] = J_OUT | DOC_CLOSE;
+
+  doc_row(dfa, J_STRING, J_STRING);
+  dfa->delta[J_STRING]['"'] = J_OUT;
+  dfa->delta[J_STRING]['\\'] = J_ESCAPE;
+
+  doc_row(dfa, J_ESCAPE, J_STRING);
+
+  dfa->initial = J_OUT;
+  dfa->candidates[0] = J_OUT;
+  dfa->candidates[1] = J_STRING;
+  dfa->num_candidates = 2;
+  dfa->split = json_split;
+}
+
+// It computes the number of symbols that leave each state (or emit a
+// parenthesis). The runs of symbols of a state that has a single exit are
+// skipped with memchr
+static void doc_exits(struct doc_dfa* dfa) {
+  for(int s = 0; s < DOC_STATES; s++) {
+    dfa->num_exits[s] = 0;
+    for(int c = 0; c < 256; c++)
+      if(dfa->delta[s][c] != s) {
+	dfa->exit[s] = c;
+	dfa->num_exits[s]++;
+      }
+  }
+}
+
+// It returns the first position in text[i..last-1] that may leave the state
+// s, or last. The loads of this loop do not depend on each other, unlike the
+// transitions of the automaton
+static inline long doc_skip(const struct doc_dfa* dfa, int s, const char* text,
+			    long i, long last) {
+  if(dfa->num_exits[s] == 1) {
+    const char* p = memchr(text+i, dfa->exit[s], last-i);
+    return p ? p-text : last;
+  }
+  while(i < last && dfa->delta[s][(unsigned char)text[i]] == s)
+    i++;
+  return i;
+}
+
+// It parses text[first..last-1] from the state s
+static void doc_parse(const struct doc_dfa* dfa, const char* text, long first,
+		      long last, int s, struct doc_run* run) {
+  long count = 0, excess = 0, min_excess = 0;
+
+  for(long i = doc_skip(dfa, s, text, first, last); i < last;
+      i = doc_skip(dfa, s, text, i, last)) {
+    unsigned char x = dfa->delta[s][(unsigned char)text[i++]];
+    s = DOC_STATE(x);
+    count += (x & (DOC_OPEN | DOC_CLOSE)) != 0;
+    excess += ((x & DOC_OPEN) != 0) - ((x & DOC_CLOSE) != 0);
+    min_excess = min(min_excess, excess);
+  }
+
+  run->end = s;
+  run->count = count;
+  run->excess = excess;
+  run->min_excess = min_excess;
+}
+
+// It maps the file fn in memory and stores its size
+static const char* map_file(const char* fn, long* size) {
+  int fd = open(fn, O_RDONLY);
+  struct stat st;
+  if(fd < 0 || fstat(fd, &st)) {
+    fprintf(stderr, "Error opening file \"%s\".\n", fn);
+    exit(-1);
+  }
+
+  *size = st.st_size;
+  const char* text = (*size > 0) ?
+    mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+  if(text == MAP_FAILED) {
+    fprintf(stderr, "Error reading file \"%s\".\n", fn);
+    exit(-1);
+  }
+  close(fd);
+
+  return text;
+}
+
+static void unmap_file(const char* text, long size) {
+  if(size > 0)
+    munmap((void*)text, size);
+}
+
+BIT_ARRAY* document_to_bits(const char* fn, doc_format format, long* n) {
+  long size;
+  const char* text = map_file(fn, &size);
+
+  struct doc_dfa* dfa = (struct doc_dfa*)malloc(sizeof(struct doc_dfa));
+  if(format == DOC_XML)
+    xml_dfa(dfa);
+  else
+    json_dfa(dfa);
+  doc_exits(dfa);
+
+  unsigned int chunks = (size < 4096*threads) ? 1 : threads;
+  struct doc_chunk* chunk =
+    (struct doc_chunk*)malloc(chunks*sizeof(struct doc_chunk));
+
+  chunk[0].first = 0;
+  cilk_for(unsigned int k = 1; k < chunks; k++)
+    chunk[k].first = dfa->split(text, k*(size/chunks), size);
+  for(unsigned int k = 1; k < chunks; k++) // A chunk may be empty
+    chunk[k].first = max(chunk[k].first, chunk[k-1].first);
+  for(unsigned int k = 0; k < chunks; k++)
+    chunk[k].last = (k+1 < chunks) ? chunk[k+1].first : size;
+
+  // The first chunk starts in the initial state
+  cilk_for(unsigned int k = 0; k < chunks; k++)
+    if(k == 0)
+      doc_parse(dfa, text, chunk[k].first, chunk[k].last, dfa->initial,
+		chunk[k].runs);
+    else
+      for(int c = 0; c < dfa->num_candidates; c++)
+	doc_parse(dfa, text, chunk[k].first, chunk[k].last,
+		  dfa->candidates[c], &chunk[k].runs[c]);
+
+  // The root of the tree is the document, so the elements (or values) at
+  // the top level are its children. Its opening parenthesis is at position 0
+  int state = dfa->initial;
+  long position = 1, excess = 0;
+
+  for(unsigned int k = 0; k < chunks; k++) {
+    struct doc_run* run = NULL;
+
+    if(k == 0)
+      run = &chunk[k].runs[0];
+    else
+      for(int c = 0; c < dfa->num_candidates; c++)
+	if(dfa->candidates[c] == state)
+	  run = &chunk[k].runs[c];
+
+    if(!run) { // Wrong speculation
+      run = &chunk[k].runs[0];
+      doc_parse(dfa, text, chunk[k].first, chunk[k].last, state, run);
+    }
+
+    if(excess + run->min_excess < 0) {
+      fprintf(stderr, "Error: unbalanced structure in \"%s\"\n", fn);
+      exit(EXIT_FAILURE);
+    }
+
+    chunk[k].start = state;
+    chunk[k].position = position;
+    state = run->end;
+    position += run->count;
+    excess += run->excess;
+  }
+
+  if(excess != 0 || state != dfa->initial) {
+    fprintf(stderr, "Error: unbalanced structure in \"%s\"\n", fn);
+    exit(EXIT_FAILURE);
+  }
+
+  *n = position+1;
+  BIT_ARRAY* B = bit_array_create(*n);
+  bit_array_set_bit(B, 0);
+
+  // Each chunk writes its opening parentheses
+  cilk_for(unsigned int k = 0; k < chunks; k++) {
+    long first = chunk[k].position;
+    long last = (k+1 < chunks) ? chunk[k+1].position : *n-1;
+    long i = first, w = first >> logW;
+    word_t bits = 0;
+    int s = chunk[k].start;
+
+    for(long j = doc_skip(dfa, s, text, chunk[k].first, chunk[k].last);
+	j < chunk[k].last; j = doc_skip(dfa, s, text, j, chunk[k].last)) {
+      unsigned char x = dfa->delta[s][(unsigned char)text[j++]];
+      s = DOC_STATE(x);
+      if(!(x & (DOC_OPEN | DOC_CLOSE)))
+	continue;
+
+      if((i >> logW) != w) {
+	flush_word(B, w, bits, first, last);
+	w = i >> logW;
+	bits = 0;
+      }
+      if(x & DOC_OPEN)
+	bits |= (word_t)1 << (i & (word_size-1));
+      i++;
+    }
+    flush_word(B, w, bits, first, last);
+  }
+
+  free(chunk);
+  free(dfa);
+  unmap_file(text, size);
+
+  return B;
+}
+
+/*
+ * Newick: the nodes are the parenthesized subtrees and the leaves. Labels may
+ * be quoted ('' is a quote inside a quoted label), branch lengths follow a
+ * ':' and comments are enclosed in brackets. A leaf has no parentheses in the
+ * text, so its pair is emitted when its label ends (',' or ')'). The file is
+ * split after commas, so every chunk starts with a new leaf or subtree if the
+ * comma was not quoted or commented. Otherwise the chunk is parsed as the
+ * continuation of the previous one. The labels and branch lengths of the
+ * nodes closed by a chunk but opened by a previous one are kept apart and
+ * assigned to their nodes sequentially, matching the unmatched parentheses
+ * of the chunks.
+ */
+
+enum { N_NORMAL, N_QUOTED, N_QUOTE_END, N_COMMENT, N_DONE };
+
+// Maximal number of symbols of a branch length
+#define NEWICK_NUMBER 64
+
+struct newick_state {
+  int lex;
+  int fresh; // The current label belongs to a new leaf
+  int in_length; // After ':'
+  long error; // Position of the first error, or -1
+  long count; // Number of parentheses
+  long nodes;
+  long bytes; // Bytes of the labels, including their terminators
+  long excess, min_excess, max_excess;
+  long min_comma; // Minimum excess at a comma
+};
+
+// Output of the second pass over a chunk
+struct newick_out {
+  BIT_ARRAY* B;
+  long first, last; // Positions of the parentheses of the chunk
+  long i, w; // Position of the next parenthesis and its word
+  word_t bits;
+  long rank; // Preorder rank of the next node
+  char* text; // Labels
+  long offset; // Position of the next byte of the labels
+  long label; // Position of the current label
+  long current; // Node of the current label: its rank, or -(j+1) for the
+		// pending node j
+  long* labels;
+  double* lengths;
+  long* stack; // Preorder ranks of the nodes opened by the chunk
+  long top;
+  long* pending_labels; // Nodes closed by the chunk, opened by a previous one
+  double* pending_lengths;
+  long pending;
+  char number[NEWICK_NUMBER];
+  int digits;
+};
+
+// Symbols of unquoted labels and of branch lengths (see newick_to_bits)
+static unsigned char newick_plain[256];
+
+static const struct newick_state newick_initial = {
+  N_NORMAL, 1, 0, -1, 0, 0, 0, 0, 0, 0, LONG_MAX
+};
+
+static inline void newick_put(struct newick_out* out, int bit) {
+  if((out->i >> logW) != out->w) {
+    flush_word(out->B, out->w, out->bits, out->first, out->last);
+    out->w = out->i >> logW;
+    out->bits = 0;
+  }
+  if(bit)
+    out->bits |= (word_t)1 << (out->i & (word_size-1));
+  out->i++;
+}
+
+static inline void newick_label_char(struct newick_state* st,
+				     struct newick_out* out, char c) {
+  st->bytes++;
+  if(out)
+    out->text[out->offset++] = c;
+}
+
+// It returns the value of a branch length. Decimal numbers without exponent
+// whose digits fit in the mantissa of a double are exact by a single
+// division, the others are parsed by strtod
+static inline double newick_number(char* number, int digits) {
+  static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+				   1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+				   1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  int k = (number[0] == '-' || number[0] == '+'), point = -1, significant = 0;
+  uint64_t mantissa = 0;
+
+  for(; k < digits; k++) {
+    char c = number[k];
+    if(c >= '0' && c <= '9') {
+      mantissa = 10*mantissa + (c - '0');
+      significant += (mantissa > 0);
+    }
+    else if(c == '.' && point < 0)
+      point = k;
+    else
+      break;
+  }
+
+  int decimals = (point < 0) ? 0 : digits-point-1;
+  if(k < digits || significant > 15 || decimals > 22) {
+    number[digits] = '\0';
+    return strtod(number, NULL);
+  }
+
+  double value = (double)mantissa / powers[decimals];
+  return (number[0] == '-') ? -value : value;
+}
+
+// The current label ends: it is assigned to a new leaf or to the last node
+// closed
+static inline void newick_end_label(struct newick_state* st,
+				    struct newick_out* out) {
+  long node = 0;
+
+  if(st->fresh) {
+    st->count += 2;
+    st->nodes++;
+  }
+  st->bytes++;
+
+  if(!out)
+    return;
+
+  if(st->fresh) {
+    newick_put(out, 1);
+    newick_put(out, 0);
+    node = out->rank++;
+  }
+  else
+    node = out->current;
+
+  out->text[out->offset++] = '\0';
+  double length = out->digits ? newick_number(out->number, out->digits) : NAN;
+
+  if(node >= 0) {
+    out->labels[node] = out->label;
+    out->lengths[node] = length;
+  }
+  else {
+    out->pending_labels[-node-1] = out->label;
+    out->pending_lengths[-node-1] = length;
+  }
+}
+
+// It parses text[first..last-1] from the state st. If out is NULL it only
+// counts the nodes, the parentheses and the bytes of the labels
+static void newick_parse(const char* text, long first, long last,
+			 struct newick_state* st, struct newick_out* out) {
+  for(long i = first; i < last && st->error < 0; i++) {
+    char c = text[i];
+
+    switch(st->lex) {
+    case N_COMMENT:
+      if(c == ']')
+	st->lex = N_NORMAL;
+      continue;
+    case N_QUOTED:
+      if(c == '\'')
+	st->lex = N_QUOTE_END;
+      else
+	newick_label_char(st, out, c);
+      continue;
+    case N_QUOTE_END:
+      if(c == '\'') {
+	newick_label_char(st, out, c);
+	st->lex = N_QUOTED;
+	continue;
+      }
+      st->lex = N_NORMAL;
+      break;
+    case N_DONE:
+      if(c != ' ' && c != '\t' && c != '\n' && c != '\r')
+	st->error = i;
+      continue;
+    }
+
+    switch(c) {
+    case '(':
+      if(!st->fresh) {
+	st->error = i;
+	continue;
+      }
+      st->count++;
+      st->nodes++;
+      st->excess++;
+      st->max_excess = max(st->max_excess, st->excess);
+      if(out) {
+	newick_put(out, 1);
+	out->stack[out->top++] = out->rank++;
+	out->label = out->offset;
+      }
+      break;
+    case ',':
+    case ')':
+    case ';':
+      newick_end_label(st, out);
+      st->in_length = 0;
+      if(out) {
+	out->label = out->offset;
+	out->digits = 0;
+      }
+
+      if(c == ',') {
+	st->min_comma = min(st->min_comma, st->excess);
+	st->fresh = 1;
+      }
+      else if(c == ')') {
+	st->count++;
+	st->excess--;
+	st->min_excess = min(st->min_excess, st->excess);
+	st->fresh = 0;
+	if(out) {
+	  newick_put(out, 0);
+	  out->current = (out->top > 0) ? out->stack[--out->top] :
+	    -(++out->pending);
+	}
+      }
+      else
+	st->lex = N_DONE;
+      break;
+    case ':':
+      st->in_length = 1;
+      break;
+    case '[':
+      st->lex = N_COMMENT;
+      break;
+    case '\'':
+      st->lex = N_QUOTED;
+      break;
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      break;
+    default: { // A run of symbols of a label or of a branch length
+      long j = i+1;
+      while(j < last && newick_plain[(unsigned char)text[j]])
+	j++;
+
+      if(!st->in_length) {
+	st->bytes += j-i;
+	if(out) {
+	  memcpy(out->text + out->offset, text+i, j-i);
+	  out->offset += j-i;
+	}
+      }
+      else if(out) {
+	int len = min(j-i, NEWICK_NUMBER-1 - out->digits);
+	memcpy(out->number + out->digits, text+i, len);
+	out->digits += len;
+      }
+      i = j-1;
+    }
+    }
+  }
+}
+
+// It reports an error at the position i of the text
+static void newick_error(const char* fn, const char* text, long i) {
+  long line = 1;
+  for(long j = 0; j < i; j++)
+    line += (text[j] == '\n');
+  fprintf(stderr, "Error: invalid Newick tree in \"%s\" (line %ld)\n", fn, line);
+  exit(EXIT_FAILURE);
+}
+
+BIT_ARRAY* newick_to_bits(const char* fn, newick_data* data, long* n) {
+  long size;
+  const char* text = map_file(fn, &size);
+
+  for(int c = 0; c < 256; c++)
+    newick_plain[c] = !strchr("()[]':;, \t\n\r", c);
+
+  unsigned int chunks = (size < 4096*threads) ? 1 : threads;
+  long* first = (long*)malloc((chunks+1)*sizeof(long));
+  struct newick_state* state =
+    (struct newick_state*)malloc(chunks*sizeof(struct newick_state));
+
+  // Each chunk starts after a comma
+  first[0] = 0;
+  first[chunks] = size;
+  cilk_for(unsigned int k = 1; k < chunks; k++) {
+    const char* comma = memchr(text + k*(size/chunks), ',',
+			       size - k*(size/chunks));
+    first[k] = comma ? comma-text+1 : size;
+  }
+  for(unsigned int k = 1; k < chunks; k++) // A chunk may be empty
+    first[k] = max(first[k], first[k-1]);
+
+  cilk_for(unsigned int k = 0; k < chunks; k++) {
+    state[k] = newick_initial;
+    newick_parse(text, first[k], first[k+1], &state[k], NULL);
+  }
+
+  // A chunk whose first comma was quoted or commented is appended to the
+  // last valid chunk, whose parse is resumed. Then, the position of the first
+  // parenthesis, node and byte of each chunk is computed
+  long* last = (long*)malloc(chunks*sizeof(long));
+  long* position = (long*)malloc(chunks*sizeof(long));
+  long* rank = (long*)malloc(chunks*sizeof(long));
+  long* offset = (long*)malloc(chunks*sizeof(long));
+  unsigned int p = 0;
+
+  last[0] = first[1];
+  for(unsigned int k = 1; k < chunks; k++) {
+    if(state[p].lex != N_NORMAL) {
+      newick_parse(text, first[k], first[k+1], &state[p], NULL);
+      last[p] = first[k+1];
+      last[k] = first[k]; // Empty
+      state[k] = newick_initial;
+    }
+    else {
+      p = k;
+      last[k] = first[k+1];
+    }
+  }
+
+  long count = 0, nodes = 0, bytes = 0, excess = 0;
+  int lex = N_NORMAL;
+  for(unsigned int k = 0; k < chunks; k++) {
+    position[k] = count;
+    rank[k] = nodes;
+    offset[k] = bytes;
+    if(last[k] == first[k] && k > 0)
+      continue;
+
+    if(state[k].error >= 0)
+      newick_error(fn, text, state[k].error);
+    if(excess + state[k].min_excess < 0 ||
+       (state[k].min_comma != LONG_MAX && excess + state[k].min_comma < 1))
+      newick_error(fn, text, first[k]);
+
+    count += state[k].count;
+    nodes += state[k].nodes;
+    bytes += state[k].bytes;
+    excess += state[k].excess;
+    lex = state[k].lex;
+  }
+  if(lex != N_DONE || excess != 0)
+    newick_error(fn, text, size);
+
+  *n = count;
+  BIT_ARRAY* B = bit_array_create(count);
+  data->nodes = nodes;
+  data->label_text = (char*)malloc(bytes);
+  data->labels = (long*)malloc(nodes*sizeof(long));
+  data->lengths = (double*)malloc(nodes*sizeof(double));
+
+  struct newick_out* out =
+    (struct newick_out*)malloc(chunks*sizeof(struct newick_out));
+
+  // Each chunk writes its parentheses, labels and lengths
+  cilk_for(unsigned int k = 0; k < chunks; k++) {
+    struct newick_state st = newick_initial;
+    struct newick_out* o = &out[k];
+
+    o->B = B;
+    o->first = o->i = position[k];
+    o->last = position[k] + state[k].count;
+    o->w = o->first >> logW;
+    o->bits = 0;
+    o->rank = rank[k];
+    o->text = data->label_text;
+    o->offset = o->label = offset[k];
+    o->current = 0;
+    o->labels = data->labels;
+    o->lengths = data->lengths;
+    o->stack = (long*)malloc((state[k].max_excess - state[k].min_excess + 1)*
+			     sizeof(long));
+    o->top = 0;
+    o->pending_labels = (long*)malloc((1 - state[k].min_excess)*sizeof(long));
+    o->pending_lengths =
+      (double*)malloc((1 - state[k].min_excess)*sizeof(double));
+    o->pending = 0;
+    o->digits = 0;
+
+    if(last[k] > first[k]) {
+      newick_parse(text, first[k], last[k], &st, o);
+      flush_word(B, o->w, o->bits, o->first, o->last);
+    }
+  }
+
+  // The nodes closed by each chunk and opened by a previous one are the
+  // last ones that remain open
+  long* stack = (long*)malloc(max(nodes, 1)*sizeof(long));
+  long top = 0;
+  for(unsigned int k = 0; k < chunks; k++) {
+    for(long j = 0; j < out[k].pending; j++) {
+      long v = stack[--top];
+      data->labels[v] = out[k].pending_labels[j];
+      data->lengths[v] = out[k].pending_lengths[j];
+    }
+    for(long j = 0; j < out[k].top; j++)
+      stack[top++] = out[k].stack[j];
+
+    free(out[k].stack);
+    free(out[k].pending_labels);
+    free(out[k].pending_lengths);
+  }
+
+  free(stack);
+  free(out);
+  free(first);
+  free(last);
+  free(state);
+  free(position);
+  free(rank);
+  free(offset);
+  unmap_file(text, size);
+
+  return B;
+}
+
+void free_newick(newick_data* data) {
+  free(data->label_text);
+  free(data->labels);
+  free(data->lengths);
+}
@@ -0,0 +1,98 @@
+
+/******************************************************************************
+ * bp_input.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef BP_INPUT_H
+#define BP_INPUT_H
+
+#include "bit_array.h"
+
+/*
+ * Parallel construction of the balanced parentheses sequence of a tree given
+ * in other formats. The children of each node are sorted by their
+ * identifiers (unless an edge list keeps its own order), so a parent array in
+ * preorder produces the same sequence that was used to compute it (see
+ * st_parent_array).
+ */
+
+// It reads a parent array from a binary file of 32-bit integers. The entry v
+// is the parent of the node v, and -1 for the root
+int32_t* read_parent_array(const char* fn, long* nodes);
+
+// It reads an LCP array from a binary file of 32-bit integers (see
+// suffix_tree_lcp)
+int32_t* read_lcp_array(const char* fn, long* n);
+
+// It returns the balanced parentheses sequence of the tree given by a parent
+// array of 'nodes' nodes, in any order, and stores its length in n
+BIT_ARRAY* parents_to_bits(const int32_t* parents, long nodes, long* n);
+
+// Order of the children of a node built from an edge list
+typedef enum {
+  EDGE_ORDER_INPUT, // Order of the edges in the list
+  EDGE_ORDER_ID // Sorted by identifier
+} edge_order;
+
+// It reads an edge list from a text file with one edge "parent child" per
+// line (lines starting with '#' are ignored). The file is parsed in parallel
+// and the edges are returned as pairs of integers, storing their number in m
+int32_t* read_edge_list(const char* fn, long* m);
+
+// It returns the balanced parentheses sequence of the tree given by the 'm'
+// edges (edges[2e], edges[2e+1]) = (parent, child), in any order. The nodes
+// must be numbered from 0 to m
+BIT_ARRAY* edges_to_bits(const int32_t* edges, long m, edge_order order,
+			 long* n);
+
+// Formats of the documents whose structure is a tree
+typedef enum {
+  DOC_XML, // Elements
+  DOC_JSON // Objects and arrays
+} doc_format;
+
+// It returns the balanced parentheses sequence of the structure of an XML or
+// JSON document. The root is the document itself, whose children are the
+// elements (or values) at the top level. The file is mapped in memory and
+// parsed in parallel
+BIT_ARRAY* document_to_bits(const char* fn, doc_format format, long* n);
+
+// Labels and branch lengths of the nodes of a Newick tree, in preorder
+typedef struct {
+  long nodes;
+  char* label_text; // Labels, terminated by '\0'
+  long* labels; // The label of the node v is label_text + labels[v]
+  double* lengths; // Branch lengths, NAN if they are missing
+} newick_data;
+
+// It returns the balanced parentheses sequence of the tree in a Newick file,
+// and stores the labels and branch lengths of its nodes in data. The file is
+// mapped in memory and parsed in parallel
+BIT_ARRAY* newick_to_bits(const char* fn, newick_data* data, long* n);
+void free_newick(newick_data* data);
+
+#endif // BP_INPUT_H
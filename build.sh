@@ -9,12 +9,28 @@ DEFS_MEM="-std=gnu99 -ffast-math -DNOPARALLEL -DEXTRA -DMALLOC_COUNT"
 gcc -O2 -c bit_array.c
 
 echo "Compiling sequential algorithm ..."
-gcc -O2 -o st_seq $DEFS_SEQ main.c util.c bit_array.o succinct_tree.c lookup_tables.c -lrt -lm
+gcc -O2 -o st_seq $DEFS_SEQ main.c util.c bp_input.c cartesian_tree.c louds.c dfuds.c tree_arrays.c \
+bit_array.o succinct_tree.c lookup_tables.c pioneer.c -lrt -lm
 
 echo "Compiling parallel algorithm ..."
-gcc -O2 -o st_par $DEFS_PAR main.c util.c bit_array.o succinct_tree.c lookup_tables.c -fcilkplus -lcilkrts -lrt -lm 
+gcc -O2 -o st_par $DEFS_PAR main.c util.c bp_input.c cartesian_tree.c louds.c dfuds.c tree_arrays.c \
+bit_array.o succinct_tree.c lookup_tables.c pioneer.c -fcilkplus -lcilkrts -lrt -lm 
 
 echo "Compiling sequential algorithm (Working space) ..."
 gcc -c malloc_count.c
-gcc -O2 -std=gnu99 -o st_mem $DEFS_MEM main.c util.c bit_array.o malloc_count.o \
-succinct_tree.c lookup_tables.c -lrt -lm -ldl
+gcc -O2 -std=gnu99 -o st_mem $DEFS_MEM main.c util.c bp_input.c cartesian_tree.c louds.c dfuds.c \
+tree_arrays.c bit_array.o malloc_count.o succinct_tree.c lookup_tables.c pioneer.c -lrt -lm -ldl
+
+echo "Compiling query benchmarks ..."
+gcc -O2 -o st_bench $DEFS_SEQ bench.c util.c bit_array.o succinct_tree.c lookup_tables.c pioneer.c \
+batch_queries.c tree_iterator.c tree_arrays.c cartesian_tree.c louds.c dfuds.c dynamic_tree.c -lrt -lm
+gcc -O2 -o st_bench_par $DEFS_PAR bench.c util.c bit_array.o succinct_tree.c lookup_tables.c pioneer.c \
+batch_queries.c tree_iterator.c tree_arrays.c cartesian_tree.c louds.c dfuds.c dynamic_tree.c \
+-fcilkplus -lcilkrts -lrt -lm
+
+echo "Compiling sequential algorithm and query benchmarks with pioneers ..."
+gcc -O2 -o st_seq_pioneer $DEFS_SEQ -DPIONEER main.c util.c bp_input.c cartesian_tree.c louds.c dfuds.c \
+tree_arrays.c bit_array.o succinct_tree.c lookup_tables.c pioneer.c -lrt -lm
+gcc -O2 -o st_bench_pioneer $DEFS_SEQ -DPIONEER bench.c util.c bit_array.o succinct_tree.c \
+lookup_tables.c batch_queries.c pioneer.c tree_iterator.c tree_arrays.c cartesian_tree.c louds.c dfuds.c \
+dynamic_tree.c -lrt -lm
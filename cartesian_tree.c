@@ -0,0 +1,293 @@
+
+/******************************************************************************
+ * cartesian_tree.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cartesian_tree.h"
+#include "util.h"
+#include "basic.h"
+
+/*
+ * The node i closes right after the opening parentheses of the nodes whose
+ * subtree starts at i, that is, the nodes a with pse(a) = i-1, where pse(a)
+ * is the previous position whose value is smaller than or equal to A[a] (-1
+ * if none). The sequence is the opening parenthesis of the root, then, for
+ * each i, those opening parentheses and the closing parenthesis of i, and
+ * the closing parenthesis of the root.
+ *
+ * The previous smaller or equal values are computed in blocks, one per
+ * thread. The ones inside the block are found following the chains of pse
+ * (as a stack). The positions without one in the block are the prefix minima
+ * of the block, so they are resolved from left to right with a single walk
+ * over the chains of the previous blocks, skipping the blocks whose minimum
+ * is larger.
+ */
+
+// Values are compared through an order-preserving unsigned key
+struct values_t {
+  const int32_t* ints;
+  const float* floats;
+  long mirror; // If it is not negative, the position i is read at mirror-i
+};
+
+static inline uint32_t key(const struct values_t* A, long i) {
+  if(A->mirror >= 0)
+    i = A->mirror - i;
+  if(A->ints)
+    return (uint32_t)A->ints[i] ^ 0x80000000u;
+
+  uint32_t bits;
+  memcpy(&bits, &A->floats[i], sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+}
+
+static int32_t* previous_smaller(const struct values_t* A, long m) {
+  int32_t* pse = (int32_t*)malloc(m*sizeof(int32_t));
+  unsigned int blocks = (m < threads) ? 1 : threads;
+  long per_block = (m + blocks - 1)/blocks;
+  uint32_t* block_min = (uint32_t*)malloc(blocks*sizeof(uint32_t));
+
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, m);
+    uint32_t bmin = UINT32_MAX;
+
+    for(long i = first; i < last; i++) {
+      uint32_t x = key(A, i);
+      long k = i-1;
+      while(k >= first && key(A, k) > x)
+	k = pse[k];
+      pse[i] = (k >= first) ? k : -1;
+      bmin = min(bmin, x);
+    }
+    block_min[b] = bmin;
+  }
+
+  // A chain may be read while its block is resolved: both a pse of the
+  // block and the end of the previous block are valid steps
+  cilk_for(unsigned int b = 1; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, m);
+    long k = first-1;
+
+    for(long i = first; i < last; i++) {
+      if(pse[i] >= 0)
+	continue;
+
+      uint32_t x = key(A, i);
+      while(k >= 0 && key(A, k) > x) {
+	long next = pse[k];
+	if(next < 0)
+	  next = (k/per_block)*per_block - 1;
+	while(next >= 0 && block_min[next/per_block] > x)
+	  next = (next/per_block)*per_block - 1;
+	k = next;
+      }
+      pse[i] = k;
+    }
+  }
+
+  free(block_min);
+
+  return pse;
+}
+
+// If the sequence is shorter than min_n, leaves with an infinite value are
+// appended to the root, which does not change the queries on A
+static BIT_ARRAY* cartesian_tree(const struct values_t* A, long m, long min_n,
+				 long* n) {
+  *n = max(2*m+2, min_n + (min_n & 1));
+  BIT_ARRAY* B = bit_array_create(*n);
+  bit_array_set_bit(B, 0);
+  for(long p = 2*m+1; p < *n-1; p += 2)
+    bit_array_set_bit(B, p);
+  if(m == 0)
+    return B;
+
+  int32_t* pse = previous_smaller(A, m);
+
+  // Number of opening parentheses before the closing parenthesis of each
+  // node, and their prefix sum
+  int32_t* opens = (int32_t*)calloc(m, sizeof(int32_t));
+  cilk_for(long a = 0; a < m; a++)
+    __sync_fetch_and_add(&opens[pse[a]+1], 1);
+  free(pse);
+
+  long* sums = (long*)malloc(m*sizeof(long));
+  cilk_for(long i = 0; i < m; i++)
+    sums[i] = opens[i];
+  prefix_sum(sums, m);
+
+  unsigned int blocks = (m < threads) ? 1 : threads;
+  long per_block = (m + blocks - 1)/blocks;
+
+  // The closing parenthesis of i is at 1+i+sums[i], right after opens[i]
+  // opening parentheses. Each block writes the range of its parentheses
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, m);
+    if(first < last) {
+      long lo = 1 + first + sums[first] - opens[first];
+      long hi = 1 + (last-1) + sums[last-1] + 1;
+
+      for(long i = first; i < last; i++) {
+	long pos = 1 + i + sums[i];
+	set_bit_range(B, pos - opens[i], pos, lo, hi);
+      }
+    }
+  }
+
+  free(opens);
+  free(sums);
+
+  return B;
+}
+
+BIT_ARRAY* cartesian_tree_int(const int32_t* A, long m, long* n) {
+  struct values_t values = {A, NULL, -1};
+  return cartesian_tree(&values, m, 0, n);
+}
+
+BIT_ARRAY* cartesian_tree_float(const float* A, long m, long* n) {
+  struct values_t values = {NULL, A, -1};
+  return cartesian_tree(&values, m, 0, n);
+}
+
+/*
+ * The boundary k (between the leaves k and k+1) has the value lcp[k+1]. Its
+ * lcp-interval starts after the previous boundary with a smaller value and
+ * ends before the next one, and the boundaries of the interval with the same
+ * value are merged into one node. So each internal node opens before the
+ * leaf pse(k)+1 for its leftmost boundary k, whose previous smaller or equal
+ * value is smaller, and closes after the leaf nse(k) for its rightmost
+ * boundary k, whose next smaller or equal value is smaller. The next ones
+ * are the previous ones of the mirrored array.
+ */
+BIT_ARRAY* suffix_tree_lcp(const int32_t* lcp, long n, long* bits) {
+  if(n <= 0) {
+    fprintf(stderr, "Error: the LCP array is empty\n");
+    exit(EXIT_FAILURE);
+  }
+
+  long m = n-1;
+  const int32_t* L = lcp+1;
+  int32_t* opens = (int32_t*)calloc(n, sizeof(int32_t));
+  int32_t* closes = (int32_t*)calloc(n, sizeof(int32_t));
+
+  if(m > 0) {
+    struct values_t values = {L, NULL, -1};
+    int32_t* pse = previous_smaller(&values, m);
+    cilk_for(long k = 0; k < m; k++)
+      if(pse[k] < 0 || L[pse[k]] < L[k])
+	__sync_fetch_and_add(&opens[pse[k]+1], 1);
+    free(pse);
+
+    struct values_t mirrored = {L, NULL, m-1};
+    int32_t* nse = previous_smaller(&mirrored, m);
+    cilk_for(long r = 0; r < m; r++) {
+      long k = m-1-r, next = m-1-nse[r];
+      if(next == m || L[next] < L[k])
+	__sync_fetch_and_add(&closes[next], 1);
+    }
+    free(nse);
+  }
+
+  // Each leaf j is written as opens[j] opening parentheses, the leaf and
+  // closes[j] closing parentheses, from the position 2j + sums[j-1]
+  long* sums = (long*)malloc(n*sizeof(long));
+  cilk_for(long j = 0; j < n; j++)
+    sums[j] = opens[j] + closes[j];
+  prefix_sum(sums, n);
+
+  *bits = 2*n + sums[n-1];
+  BIT_ARRAY* B = bit_array_create(*bits);
+
+  unsigned int blocks = (n < threads) ? 1 : threads;
+  long per_block = (n + blocks - 1)/blocks;
+
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, n);
+    if(first < last) {
+      long lo = 2*first + sums[first] - opens[first] - closes[first];
+      long hi = 2*last + sums[last-1];
+
+      for(long j = first; j < last; j++) {
+	long pos = 2*j + sums[j] - opens[j] - closes[j];
+	set_bit_range(B, pos, pos + opens[j] + 1, lo, hi);
+      }
+    }
+  }
+
+  free(opens);
+  free(closes);
+  free(sums);
+
+  return B;
+}
+
+// st_create needs more than one chunk of parentheses
+#define RMQ_MIN_PARENTHESES 258
+
+static rmq_index* rmq_create(const struct values_t* A, long m) {
+  rmq_index* r = (rmq_index*)malloc(sizeof(rmq_index));
+  long n;
+  BIT_ARRAY* B = cartesian_tree(A, m, RMQ_MIN_PARENTHESES, &n);
+
+  r->m = m;
+  r->st = st_create(B, n);
+
+  return r;
+}
+
+rmq_index* rmq_create_int(const int32_t* A, long m) {
+  struct values_t values = {A, NULL, -1};
+  return rmq_create(&values, m);
+}
+
+rmq_index* rmq_create_float(const float* A, long m) {
+  struct values_t values = {NULL, A, -1};
+  return rmq_create(&values, m);
+}
+
+void free_rmq_index(rmq_index* r) {
+  st_free(r->st);
+  free(r);
+}
+
+// The minimum of A[i..j] is the node of [i..j] (closing parentheses i+1 to
+// j+1) whose closing parenthesis reaches the lowest excess first. Nodes on
+// its right with the same excess are its siblings, so their values are not
+// smaller
+int32_t rmq_array(rmq_index* r, int32_t i, int32_t j) {
+  if(i == j)
+    return i;
+
+  int32_t x = select_0(r->st, i+1), y = select_0(r->st, j+1);
+
+  return rank_0(r->st, rmq(r->st, x, y)) - 1;
+}
@@ -0,0 +1,77 @@
+
+/******************************************************************************
+ * cartesian_tree.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef CARTESIAN_TREE_H
+#define CARTESIAN_TREE_H
+
+#include "succinct_tree.h"
+
+/*
+ * Succinct range minimum queries. The array A[0..m-1] is represented by the
+ * balanced parentheses of a Cartesian tree with 2m+2 parentheses, whose
+ * nodes are the positions of A in postorder under a virtual root. The parent
+ * of the position i is the next position with a smaller value, so the
+ * minimum of A[i..j] is the node of the range that closes with the lowest
+ * excess. The array itself is not needed to answer the queries.
+ */
+
+// It returns the balanced parentheses of the Cartesian tree of A[0..m-1] and
+// stores its length in n. The tree is built in parallel from the previous
+// smaller or equal value of each position
+BIT_ARRAY* cartesian_tree_int(const int32_t* A, long m, long* n);
+BIT_ARRAY* cartesian_tree_float(const float* A, long m, long* n);
+
+typedef struct {
+  long m; // Length of the array
+  rmMt* st; // rmMt of the Cartesian tree
+} rmq_index;
+
+// Construction of the range minimum query index of A[0..m-1] (st_create over
+// its Cartesian tree)
+rmq_index* rmq_create_int(const int32_t* A, long m);
+rmq_index* rmq_create_float(const float* A, long m);
+void free_rmq_index(rmq_index* r);
+
+// It returns the leftmost position of the minimum of A[i..j], 0 <= i <= j < m
+int32_t rmq_array(rmq_index* r, int32_t i, int32_t j);
+
+/*
+ * Topology of a suffix tree from its LCP array, where lcp[i] is the length of
+ * the longest common prefix of the suffixes of ranks i-1 and i (lcp[0] is
+ * ignored). The leaves are the n suffixes in lexicographic order and the
+ * internal nodes are the lcp-intervals, that is, the Cartesian tree of
+ * lcp[1..n-1] with the nodes of equal values merged.
+ */
+
+// It returns the balanced parentheses sequence of the topology of the suffix
+// tree and stores its length in bits. It is built in parallel from the
+// previous and next smaller values of the LCP array
+BIT_ARRAY* suffix_tree_lcp(const int32_t* lcp, long n, long* bits);
+
+#endif // CARTESIAN_TREE_H
@@ -0,0 +1,129 @@
+
+/******************************************************************************
+ * dfuds.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dfuds.h"
+#include "tree_arrays.h"
+#include "util.h"
+#include "basic.h"
+
+BIT_ARRAY* st_to_dfuds(rmMt* st, long* n) {
+  long nodes = st->n/2;
+  int32_t* degrees = st_degree_array(st);
+
+  // The degree of the node r starts at the position 1+r plus the degrees of
+  // the previous nodes
+  long* sums = (long*)malloc(nodes*sizeof(long));
+  cilk_for(long r = 0; r < nodes; r++)
+    sums[r] = degrees[r];
+  prefix_sum(sums, nodes);
+
+  *n = 2*nodes;
+  BIT_ARRAY* B = bit_array_create(*n);
+  bit_array_set_bit(B, 0);
+
+  unsigned int blocks = (nodes < threads) ? 1 : threads;
+  long per_block = (nodes + blocks - 1)/blocks;
+
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, nodes);
+    if(first < last) {
+      long from = 1 + first + sums[first] - degrees[first];
+      long to = 1 + last + sums[last-1];
+
+      for(long r = first; r < last; r++) {
+	long pos = 1 + r + sums[r] - degrees[r];
+	set_bit_range(B, pos, pos + degrees[r], from, to);
+      }
+    }
+  }
+
+  free(degrees);
+  free(sums);
+
+  return B;
+}
+
+dfuds_t* dfuds_create(BIT_ARRAY* B, long n) {
+  dfuds_t* d = (dfuds_t*)malloc(sizeof(dfuds_t));
+  d->nodes = n/2;
+  d->st = st_create(B, n);
+
+  return d;
+}
+
+void free_dfuds(dfuds_t* d) {
+  st_free(d->st);
+  free(d);
+}
+
+// The degree of each node ends with a closing parenthesis, so the node of
+// rank r starts after the r-th one
+int32_t dfuds_select(dfuds_t* d, int32_t r) {
+  return r ? select_0(d->st, r) + 1 : 1;
+}
+
+int32_t dfuds_rank(dfuds_t* d, int32_t x) {
+  return rank_0(d->st, x-1);
+}
+
+// The closing parenthesis before x matches the opening parenthesis of x in
+// the degree of its parent, which starts after the previous closing
+// parenthesis (or at 1 for the root)
+int32_t dfuds_parent(dfuds_t* d, int32_t x) {
+  if(x <= 1)
+    return -1;
+
+  int32_t z = prev_0(d->st, find_open(d->st, x-1));
+
+  return (z < 0) ? 1 : z+1;
+}
+
+// The t-th child matches the t-th opening parenthesis from the end of the
+// degree of x, and it starts right after it
+int32_t dfuds_child(dfuds_t* d, int32_t x, int32_t t) {
+  int32_t end = next_0(d->st, x-1);
+
+  if(t < 1 || t > end - x)
+    return -1;
+
+  return find_close(d->st, end - t) + 1;
+}
+
+int32_t dfuds_degree(dfuds_t* d, int32_t x) {
+  return next_0(d->st, x-1) - x;
+}
+
+// The degrees of a subtree of s nodes have s-1 opening and s closing
+// parentheses, and the excess before x is reached again only at its end
+int32_t dfuds_subtree_size(dfuds_t* d, int32_t x) {
+  return (fwd_search(d->st, x-1, 0) - x + 2)/2;
+}
@@ -0,0 +1,77 @@
+
+/******************************************************************************
+ * dfuds.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef DFUDS_H
+#define DFUDS_H
+
+#include "succinct_tree.h"
+
+/*
+ * Depth-first unary degree sequence (DFUDS). The sequence is an opening
+ * parenthesis followed by the degree of each node in preorder, written as d
+ * opening parentheses and a closing one. It is balanced, so the navigation
+ * uses the rmMt built over it (fwd_search, find_close and find_open). A node
+ * is identified by the position of the first parenthesis of its degree (the
+ * root is 1), and child and degree do not depend on the number of siblings.
+ */
+
+typedef struct {
+  long nodes; // Number of nodes
+  rmMt* st; // rmMt of the DFUDS sequence
+} dfuds_t;
+
+// It returns the DFUDS sequence of the tree of st and stores its length in
+// n. Each node writes its degree (see st_degree_array) at the position given
+// by a parallel prefix sum of the degrees in preorder
+BIT_ARRAY* st_to_dfuds(rmMt* st, long* n);
+
+// Construction of the DFUDS representation (st_create over the sequence
+// returned by st_to_dfuds)
+dfuds_t* dfuds_create(BIT_ARRAY* B, long n);
+void free_dfuds(dfuds_t* d);
+
+// Conversion between the preorder rank of a node (the root has rank 0) and
+// its position
+int32_t dfuds_select(dfuds_t* d, int32_t r);
+int32_t dfuds_rank(dfuds_t* d, int32_t x);
+
+// It returns the parent of the node x, or -1 for the root
+int32_t dfuds_parent(dfuds_t* d, int32_t x);
+
+// It returns the t-th child of the node x (t >= 1), or -1 if it does not
+// exist
+int32_t dfuds_child(dfuds_t* d, int32_t x, int32_t t);
+
+// It returns the number of children of the node x
+int32_t dfuds_degree(dfuds_t* d, int32_t x);
+
+// It returns the number of nodes of the subtree of the node x
+int32_t dfuds_subtree_size(dfuds_t* d, int32_t x);
+
+#endif // DFUDS_H
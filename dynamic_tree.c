@@ -0,0 +1,1007 @@
+
+/******************************************************************************
+ * dynamic_tree.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynamic_tree.h"
+#include "util.h"
+#include "basic.h"
+
+// Words of a block, with a spare word for the bit copies
+#define DYN_WORDS (DYN_MAX_BITS/word_size + 1)
+
+static inline int get_bit(const word_t* words, long p) {
+  return (words[p >> logW] >> (p & (word_size-1))) & 1;
+}
+
+// Byte that starts at the position p, a multiple of 8
+static inline int get_byte_at(const word_t* words, long p) {
+  return (words[p >> logW] >> (p & (word_size-1))) & 0xFF;
+}
+
+static inline void or_word(word_t* words, long w, word_t bits, int atomic) {
+  if(atomic)
+    __sync_fetch_and_or(&words[w], bits);
+  else
+    words[w] |= bits;
+}
+
+// It copies the bits src[sp..sp+len-1] to dst[dp..dp+len-1], which must be
+// zero. If atomic is set, the first and the last words of dst are written
+// atomically, since they may be shared with other threads
+static void copy_bits(word_t* dst, long dp, const word_t* src, long sp,
+		      long len, int atomic) {
+  long first = dp >> logW, last = (dp + len - 1) >> logW;
+
+  for(long k = 0; k < len; k += word_size) {
+    long p = sp + k, q = dp + k, bits = min(len - k, word_size);
+    long ps = p & (word_size-1), qs = q & (word_size-1);
+
+    word_t w = src[p >> logW] >> ps;
+    if(ps && ps + bits > word_size)
+      w |= src[(p >> logW) + 1] << (word_size - ps);
+    if(bits < word_size)
+      w &= ((word_t)1 << bits) - 1;
+
+    long wq = q >> logW;
+    or_word(dst, wq, w << qs, atomic && (wq == first || wq == last));
+    if(qs && qs + bits > word_size)
+      or_word(dst, wq+1, w >> (word_size - qs),
+	      atomic && (wq+1 == first || wq+1 == last));
+  }
+}
+
+/* Nodes of the dynamic min-max tree */
+
+static dyn_node* new_leaf() {
+  dyn_node* v = (dyn_node*)calloc(1, sizeof(dyn_node));
+  v->words = (word_t*)calloc(DYN_WORDS, sizeof(word_t));
+
+  return v;
+}
+
+static void free_node(dyn_node* v) {
+  if(v->height) {
+    free_node(v->left);
+    free_node(v->right);
+  }
+  free(v->words);
+  free(v);
+}
+
+// e, m, M and n of a block, scanned by bytes
+static void leaf_summary(dyn_node* v) {
+  int32_t excess = 0, m = INT32_MAX/2, M = INT32_MIN/2, nm = 0;
+  long p = 0;
+
+  for(; p + 8 <= v->len; p += 8) {
+    int b = get_byte_at(v->words, p);
+    int32_t bm = excess + T->min[b];
+    if(bm < m) {
+      m = bm;
+      nm = T->min_count[b];
+    }
+    else if(bm == m)
+      nm += T->min_count[b];
+    M = max(M, excess + T->max[b]);
+    excess += T->word_sum[b];
+  }
+  for(; p < v->len; p++) {
+    excess += 2*get_bit(v->words, p) - 1;
+    if(excess < m) {
+      m = excess;
+      nm = 1;
+    }
+    else if(excess == m)
+      nm++;
+    M = max(M, excess);
+  }
+
+  v->e = excess;
+  v->m = m;
+  v->M = M;
+  v->nm = nm;
+}
+
+// It computes the fields of an internal node from its children
+static void update(dyn_node* v) {
+  dyn_node* l = v->left;
+  dyn_node* r = v->right;
+  int32_t rm = l->e + r->m;
+
+  v->height = 1 + max(l->height, r->height);
+  v->len = l->len + r->len;
+  v->e = l->e + r->e;
+  v->m = min(l->m, rm);
+  v->nm = (l->m < rm) ? l->nm : (l->m > rm) ? r->nm : l->nm + r->nm;
+  v->M = max(l->M, l->e + r->M);
+}
+
+// It puts the node v in the place of the child old of parent
+static void replace_child(dyn_tree* t, dyn_node* parent, dyn_node* old,
+			  dyn_node* v) {
+  if(!parent)
+    t->root = v;
+  else if(parent->left == old)
+    parent->left = v;
+  else
+    parent->right = v;
+  v->parent = parent;
+}
+
+// The right child of x becomes its parent
+static dyn_node* rotate_left(dyn_tree* t, dyn_node* x) {
+  dyn_node* y = x->right;
+
+  replace_child(t, x->parent, x, y);
+  x->right = y->left;
+  x->right->parent = x;
+  y->left = x;
+  x->parent = y;
+  update(x);
+  update(y);
+
+  return y;
+}
+
+// The left child of x becomes its parent
+static dyn_node* rotate_right(dyn_tree* t, dyn_node* x) {
+  dyn_node* y = x->left;
+
+  replace_child(t, x->parent, x, y);
+  x->left = y->right;
+  x->left->parent = x;
+  y->right = x;
+  x->parent = y;
+  update(x);
+  update(y);
+
+  return y;
+}
+
+static inline int balance(dyn_node* v) {
+  return v->left->height - v->right->height;
+}
+
+// It updates the nodes from v up to the root, rotating the unbalanced ones.
+// In a tree whose leaves are the blocks, the taller child of an unbalanced
+// node is always internal
+static void rebalance(dyn_tree* t, dyn_node* v) {
+  while(v) {
+    update(v);
+
+    if(balance(v) > 1) {
+      if(balance(v->left) < 0)
+	rotate_left(t, v->left);
+      v = rotate_right(t, v);
+    }
+    else if(balance(v) < -1) {
+      if(balance(v->right) > 0)
+	rotate_right(t, v->right);
+      v = rotate_left(t, v);
+    }
+
+    v = v->parent;
+  }
+}
+
+// Balanced tree over the blocks leaves[lo..hi-1]
+static dyn_node* build(dyn_node** leaves, long lo, long hi) {
+  if(hi - lo == 1)
+    return leaves[lo];
+
+  long mid = (lo + hi)/2;
+  dyn_node* v = (dyn_node*)calloc(1, sizeof(dyn_node));
+  v->left = build(leaves, lo, mid);
+  v->right = build(leaves, mid, hi);
+  v->left->parent = v;
+  v->right->parent = v;
+  update(v);
+
+  return v;
+}
+
+// It returns the block that contains the position *i, and stores in *i the
+// position inside the block. With append, *i can be the end of the block
+// (the position of a new bit)
+static dyn_node* find_leaf(dyn_tree* t, long* i, int append) {
+  dyn_node* v = t->root;
+
+  while(v->height) {
+    long l = v->left->len;
+    if(*i < l || (append && *i == l))
+      v = v->left;
+    else {
+      *i -= l;
+      v = v->right;
+    }
+  }
+
+  return v;
+}
+
+dyn_tree* dyn_create(BIT_ARRAY* B, long n) {
+  if(!T)
+    T = create_lookup_tables();
+
+  dyn_tree* t = (dyn_tree*)malloc(sizeof(dyn_tree));
+  t->n = n;
+
+  // Blocks of DYN_BITS bits; the last one takes the remainder
+  long blocks = max(n/DYN_BITS, 1);
+  dyn_node** leaves = (dyn_node**)malloc(blocks*sizeof(dyn_node*));
+
+  cilk_for(long k = 0; k < blocks; k++) {
+    dyn_node* v = new_leaf();
+    long from = k*DYN_BITS;
+    v->len = (k == blocks-1) ? n - from : DYN_BITS;
+    copy_bits(v->words, 0, B->words, from, v->len, 0);
+    leaf_summary(v);
+    leaves[k] = v;
+  }
+
+  t->root = build(leaves, 0, blocks);
+  t->root->parent = NULL;
+  free(leaves);
+
+  return t;
+}
+
+void dyn_free(dyn_tree* t) {
+  free_node(t->root);
+  free(t);
+}
+
+static void collect_leaves(dyn_node* v, dyn_node** leaves, long* k) {
+  if(v->height) {
+    collect_leaves(v->left, leaves, k);
+    collect_leaves(v->right, leaves, k);
+  }
+  else
+    leaves[(*k)++] = v;
+}
+
+BIT_ARRAY* dyn_to_bits(dyn_tree* t, long* n) {
+  *n = t->n;
+  BIT_ARRAY* B = bit_array_create(*n);
+
+  // There are at most 2n/DYN_MIN_BITS + 1 blocks
+  long k = 0;
+  dyn_node** leaves = (dyn_node**)malloc((2*t->n/DYN_MIN_BITS + 2)*
+					 sizeof(dyn_node*));
+  collect_leaves(t->root, leaves, &k);
+
+  long* offsets = (long*)malloc(k*sizeof(long));
+  offsets[0] = 0;
+  for(long b = 1; b < k; b++)
+    offsets[b] = offsets[b-1] + leaves[b-1]->len;
+
+  cilk_for(long b = 0; b < k; b++)
+    if(leaves[b]->len)
+      copy_bits(B->words, offsets[b], leaves[b]->words, 0, leaves[b]->len, 1);
+
+  free(leaves);
+  free(offsets);
+
+  return B;
+}
+
+/* Updates */
+
+// A full block is split in two halves (the first one ends at a word)
+static void split(dyn_tree* t, dyn_node* v) {
+  dyn_node* r = new_leaf();
+  long half = (v->len/2) & ~(long)(word_size-1);
+
+  r->len = v->len - half;
+  copy_bits(r->words, 0, v->words, half, r->len, 0);
+  memset(v->words + (half >> logW), 0,
+	 (DYN_WORDS - (half >> logW))*sizeof(word_t));
+  v->len = half;
+  leaf_summary(v);
+  leaf_summary(r);
+
+  dyn_node* p = (dyn_node*)calloc(1, sizeof(dyn_node));
+  replace_child(t, v->parent, v, p);
+  p->left = v;
+  p->right = r;
+  v->parent = p;
+  r->parent = p;
+
+  rebalance(t, p);
+}
+
+static void insert_bit(dyn_tree* t, long i, int bit) {
+  long o = i;
+  dyn_node* v = find_leaf(t, &o, 1);
+  word_t* w = v->words;
+  long w0 = o >> logW;
+  word_t low = ((word_t)1 << (o & (word_size-1))) - 1;
+
+  for(long k = v->len >> logW; k > w0; k--)
+    w[k] = (w[k] << 1) | (w[k-1] >> (word_size-1));
+  w[w0] = (w[w0] & low) | ((w[w0] & ~low) << 1) |
+    ((word_t)bit << (o & (word_size-1)));
+
+  v->len++;
+  t->n++;
+
+  if(v->len >= DYN_MAX_BITS)
+    split(t, v);
+  else {
+    leaf_summary(v);
+    rebalance(t, v->parent);
+  }
+}
+
+// It removes the block v from the tree. Its parent is replaced by the
+// sibling of v
+static void remove_leaf(dyn_tree* t, dyn_node* v) {
+  dyn_node* p = v->parent;
+  dyn_node* s = (p->left == v) ? p->right : p->left;
+
+  replace_child(t, p->parent, p, s);
+  free(v->words);
+  free(v);
+  free(p);
+
+  rebalance(t, s->parent);
+}
+
+// The block v, which starts at position start, has less than DYN_MIN_BITS
+// bits (and its ancestors are up to date). It is merged with its next block (or with the previous one for the
+// last block) if they fit in one block, otherwise their bits are split in
+// halves
+static void underflow(dyn_tree* t, dyn_node* v, long start) {
+  dyn_node *a, *b;
+  long o;
+
+  if(start + v->len < t->n) {
+    o = start + v->len;
+    a = v;
+    b = find_leaf(t, &o, 0);
+  }
+  else {
+    o = start - 1;
+    a = find_leaf(t, &o, 0);
+    b = v;
+  }
+
+  long total = a->len + b->len;
+  if(total < DYN_MAX_BITS) {
+    copy_bits(a->words, a->len, b->words, 0, b->len, 0);
+    a->len = total;
+    leaf_summary(a);
+    remove_leaf(t, b);
+    rebalance(t, a->parent);
+    return;
+  }
+
+  word_t* words = (word_t*)calloc(2*DYN_WORDS, sizeof(word_t));
+  copy_bits(words, 0, a->words, 0, a->len, 0);
+  copy_bits(words, a->len, b->words, 0, b->len, 0);
+  memset(a->words, 0, DYN_WORDS*sizeof(word_t));
+  memset(b->words, 0, DYN_WORDS*sizeof(word_t));
+
+  a->len = total/2;
+  b->len = total - a->len;
+  copy_bits(a->words, 0, words, 0, a->len, 0);
+  copy_bits(b->words, 0, words, a->len, b->len, 0);
+  free(words);
+
+  leaf_summary(a);
+  leaf_summary(b);
+  rebalance(t, a->parent);
+  rebalance(t, b->parent);
+}
+
+static void delete_bit(dyn_tree* t, long i) {
+  long o = i;
+  dyn_node* v = find_leaf(t, &o, 0);
+  word_t* w = v->words;
+  long w0 = o >> logW;
+  word_t low = ((word_t)1 << (o & (word_size-1))) - 1;
+
+  w[w0] = (w[w0] & low) | ((w[w0] >> 1) & ~low);
+  for(long k = w0+1; k <= (v->len-1) >> logW; k++) {
+    w[k-1] |= (w[k] & 1) << (word_size-1);
+    w[k] >>= 1;
+  }
+
+  v->len--;
+  t->n--;
+  leaf_summary(v);
+  rebalance(t, v->parent);
+
+  if(v->len < DYN_MIN_BITS && v->parent)
+    underflow(t, v, i - o);
+}
+
+/* Searches. The excess before a node is 'base', and it starts at 'off' */
+
+// Excess value after the first 'count' bits of a block
+static int32_t leaf_excess(dyn_node* v, long count) {
+  long ones = 0, w = 0;
+
+  for(; (w << logW) + word_size <= count; w++)
+    ones += __builtin_popcountl(v->words[w]);
+  if(count > (w << logW))
+    ones += __builtin_popcountl(v->words[w] &
+				(((word_t)1 << (count - (w << logW))) - 1));
+
+  return 2*ones - count;
+}
+
+// First position p >= from of the block where the excess is target
+static long leaf_fwd(dyn_node* v, long from, int32_t base, int32_t target) {
+  int32_t excess = base + leaf_excess(v, from);
+  long p = from;
+
+  for(; p < v->len && (p & 7); p++) {
+    excess += 2*get_bit(v->words, p) - 1;
+    if(excess == target)
+      return p;
+  }
+  for(; p + 8 <= v->len; p += 8) {
+    int b = get_byte_at(v->words, p);
+    int32_t desired = target - excess;
+    if(desired >= -8 && desired <= 8) {
+      int x = T->near_fwd_pos[((desired+8) << 8) | b];
+      if(x < 8)
+	return p + x;
+    }
+    excess += T->word_sum[b];
+  }
+  for(; p < v->len; p++) {
+    excess += 2*get_bit(v->words, p) - 1;
+    if(excess == target)
+      return p;
+  }
+
+  return -1;
+}
+
+// Last position p <= to of the block where the excess is target. The bytes
+// whose excess range does not contain target are skipped
+static long leaf_bwd(dyn_node* v, long to, int32_t base, int32_t target) {
+  int32_t excess = base + leaf_excess(v, to+1);
+  long p = to;
+
+  for(; p >= 0 && (p & 7) != 7; p--) {
+    if(excess == target)
+      return p;
+    excess -= 2*get_bit(v->words, p) - 1;
+  }
+  for(; p >= 7; p -= 8) {
+    int b = get_byte_at(v->words, p-7);
+    int32_t before = excess - T->word_sum[b];
+    if(before + T->min[b] <= target && target <= before + T->max[b])
+      for(;; p--) {
+	if(excess == target)
+	  return p;
+	excess -= 2*get_bit(v->words, p) - 1;
+      }
+    excess = before;
+  }
+
+  return -1;
+}
+
+// First position p >= from where the excess is target. Since the excess
+// changes by one at each position, a range contains target iff m <= target
+// <= M
+static long fwd_rec(dyn_node* v, long off, int32_t base, long from,
+		    int32_t target) {
+  if(off + v->len <= from)
+    return -1;
+  if(from <= off && (target < base + v->m || target > base + v->M))
+    return -1;
+  if(!v->height) {
+    long p = leaf_fwd(v, max(from - off, 0), base, target);
+    return (p < 0) ? -1 : off + p;
+  }
+
+  long p = fwd_rec(v->left, off, base, from, target);
+  if(p >= 0)
+    return p;
+  return fwd_rec(v->right, off + v->left->len, base + v->left->e, from,
+		 target);
+}
+
+// Last position p <= to where the excess is target
+static long bwd_rec(dyn_node* v, long off, int32_t base, long to,
+		    int32_t target) {
+  if(off > to)
+    return -1;
+  if(off + v->len - 1 <= to && (target < base + v->m || target > base + v->M))
+    return -1;
+  if(!v->height) {
+    long p = leaf_bwd(v, min(to - off, v->len - 1), base, target);
+    return (p < 0) ? -1 : off + p;
+  }
+
+  long p = bwd_rec(v->right, off + v->left->len, base + v->left->e, to,
+		   target);
+  if(p >= 0)
+    return p;
+  return bwd_rec(v->left, off, base, to, target);
+}
+
+// Minimum excess in the positions [lo, hi] of a block, and the number of
+// times it is reached
+static void leaf_min(dyn_node* v, long lo, long hi, int32_t base, int32_t* m,
+		     int32_t* c) {
+  int32_t excess = base + leaf_excess(v, lo);
+  long p = lo;
+
+  for(; p <= hi; p++) {
+    if(!(p & 7) && p + 7 <= hi) {
+      int b = get_byte_at(v->words, p);
+      int32_t bm = excess + T->min[b];
+      if(bm < *m) {
+	*m = bm;
+	*c = T->min_count[b];
+      }
+      else if(bm == *m)
+	*c += T->min_count[b];
+      excess += T->word_sum[b];
+      p += 7;
+      continue;
+    }
+
+    excess += 2*get_bit(v->words, p) - 1;
+    if(excess < *m) {
+      *m = excess;
+      *c = 1;
+    }
+    else if(excess == *m)
+      (*c)++;
+  }
+}
+
+static void min_rec(dyn_node* v, long off, int32_t base, long lo, long hi,
+		    int32_t* m, int32_t* c) {
+  if(off > hi || off + v->len <= lo)
+    return;
+
+  if(lo <= off && off + v->len - 1 <= hi) {
+    int32_t vm = base + v->m;
+    if(vm < *m) {
+      *m = vm;
+      *c = v->nm;
+    }
+    else if(vm == *m)
+      *c += v->nm;
+    return;
+  }
+
+  if(!v->height) {
+    leaf_min(v, max(lo - off, 0), min(hi - off, v->len - 1), base, m, c);
+    return;
+  }
+
+  min_rec(v->left, off, base, lo, hi, m, c);
+  min_rec(v->right, off + v->left->len, base + v->left->e, lo, hi, m, c);
+}
+
+// Offset of the tth occurrence of the excess m in the bits [lo, hi] of the
+// leaf v, or -1 if there are less than t. The skipped occurrences are
+// subtracted from t
+static long leaf_min_select(dyn_node* v, long lo, long hi, int32_t base,
+			    int32_t m, int32_t* t) {
+  int32_t excess = base + leaf_excess(v, lo);
+  long p = lo;
+
+  for(; p <= hi; p++) {
+    if(!(p & 7) && p + 7 <= hi) {
+      int b = get_byte_at(v->words, p);
+      if(excess + T->min[b] != m || T->min_count[b] < *t) {
+	if(excess + T->min[b] == m)
+	  *t -= T->min_count[b];
+	excess += T->word_sum[b];
+	p += 7;
+	continue;
+      }
+      // Otherwise the answer is in this byte, which is scanned bit by bit
+    }
+
+    excess += 2*get_bit(v->words, p) - 1;
+    if(excess == m && --(*t) == 0)
+      return p;
+  }
+
+  return -1;
+}
+
+// Position of the tth occurrence of the minimum m in [lo, hi] (see min_rec).
+// The nodes inside the range whose minimum is larger than m, or that have
+// less than t minima, are skipped in constant time
+static long min_select_rec(dyn_node* v, long off, int32_t base, long lo,
+			   long hi, int32_t m, int32_t* t) {
+  if(off > hi || off + v->len <= lo || base + v->m > m)
+    return -1;
+
+  if(lo <= off && off + v->len - 1 <= hi && v->nm < *t) {
+    *t -= v->nm;
+    return -1;
+  }
+
+  if(!v->height) {
+    long p = leaf_min_select(v, max(lo - off, 0), min(hi - off, v->len - 1),
+			     base, m, t);
+    return (p >= 0) ? off + p : -1;
+  }
+
+  long p = min_select_rec(v->left, off, base, lo, hi, m, t);
+  if(p >= 0)
+    return p;
+
+  return min_select_rec(v->right, off + v->left->len, base + v->left->e, lo,
+			hi, m, t);
+}
+
+// Like range_min of the rmMt: minimum excess m in [i, j], its number of
+// occurrences c and the position of the rth one (-1 if r < 1 or c < r)
+static void range_min(dyn_tree* t, int32_t i, int32_t j, int32_t r, int32_t* m,
+		      int32_t* c, int32_t* pos) {
+  *m = INT32_MAX;
+  *c = 0;
+  *pos = -1;
+
+  min_rec(t->root, 0, 0, i, j, m, c);
+  if(r > 0 && r <= *c)
+    *pos = min_select_rec(t->root, 0, 0, i, j, *m, &r);
+}
+
+/* Updates of the tree */
+
+void insert_node(dyn_tree* t, int32_t i, int32_t j) {
+  // The new node is either inside the root or the new root
+  if(i < 0 || j <= i || j > t->n+1 ||
+     (t->n > 0 && (i == 0) != (j == t->n+1))) {
+    fprintf(stderr, "Error: invalid insertion of the node (%d, %d)\n", i, j);
+    exit(EXIT_FAILURE);
+  }
+
+  // The parentheses [i, j-2] before the insertion must be balanced
+  if(j > i+1) {
+    int32_t base = i ? dyn_sum(t, i-1) : 0;
+    int32_t m = INT32_MAX, c = 0;
+    min_rec(t->root, 0, 0, i, j-2, &m, &c);
+    if(m < base || dyn_sum(t, j-2) != base) {
+      fprintf(stderr, "Error: the parentheses between %d and %d are not "
+	      "balanced\n", i, j);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  insert_bit(t, i, 1);
+  insert_bit(t, j, 0);
+}
+
+void delete_node(dyn_tree* t, int32_t i) {
+  if(i < 0 || i >= t->n) {
+    fprintf(stderr, "Error: invalid position %d\n", i);
+    exit(EXIT_FAILURE);
+  }
+
+  i = dyn_find_open(t, i);
+  if(i == 0 && dyn_degree(t, 0) > 1) {
+    fprintf(stderr, "Error: the root has more than one child\n");
+    exit(EXIT_FAILURE);
+  }
+
+  delete_bit(t, dyn_find_close(t, i));
+  delete_bit(t, i);
+}
+
+/* Queries */
+
+// Like find_leaf, and it also stores the start of the block in off and the
+// excess before it in base
+static dyn_node* locate(dyn_tree* t, long* i, long* off, int32_t* base) {
+  dyn_node* v = t->root;
+  *off = 0;
+  *base = 0;
+
+  while(v->height) {
+    if(*i < v->left->len)
+      v = v->left;
+    else {
+      *i -= v->left->len;
+      *off += v->left->len;
+      *base += v->left->e;
+      v = v->right;
+    }
+  }
+
+  return v;
+}
+
+int dyn_get_bit(dyn_tree* t, int32_t i) {
+  long o = i;
+  dyn_node* v = find_leaf(t, &o, 0);
+
+  return get_bit(v->words, o);
+}
+
+int32_t dyn_sum(dyn_tree* t, int32_t i) {
+  if(i < 0 || i >= t->n)
+    return -1;
+
+  long o = i, off;
+  int32_t base;
+  dyn_node* v = locate(t, &o, &off, &base);
+
+  return base + leaf_excess(v, o+1);
+}
+
+// Like the searches of the rmMt, they start at the block v, where the
+// position i is at offset o, and go up the tree while the answer is not in
+// the nodes to the right (left) of i. The block starts at off and the
+// excess before it is base. They return -1 if there is no answer
+static long fwd_up(dyn_node* v, long o, long off, int32_t base,
+		   int32_t target) {
+  long p = leaf_fwd(v, o+1, base, target);
+  if(p >= 0)
+    return off + p;
+
+  off += v->len;
+  base += v->e;
+  for(; v->parent; v = v->parent)
+    if(v == v->parent->left) {
+      dyn_node* r = v->parent->right;
+      if((p = fwd_rec(r, off, base, off, target)) >= 0)
+	return p;
+      off += r->len;
+      base += r->e;
+    }
+
+  return -1;
+}
+
+// It returns the position after the answer, as bwd_search
+static long bwd_up(dyn_node* v, long o, long off, int32_t base,
+		   int32_t target) {
+  long p = o ? leaf_bwd(v, o-1, base, target) : -1;
+  if(p >= 0)
+    return off + p + 1;
+
+  for(; v->parent; v = v->parent)
+    if(v == v->parent->right) {
+      dyn_node* l = v->parent->left;
+      off -= l->len;
+      base -= l->e;
+      if((p = bwd_rec(l, off, base, off + l->len - 1, target)) >= 0)
+	return p + 1;
+    }
+
+  // The excess before the sequence is 0
+  return (target == 0) ? 0 : -1;
+}
+
+int32_t dyn_fwd_search(dyn_tree* t, int32_t i, int32_t d) {
+  long o = i, off;
+  int32_t base;
+  dyn_node* v = locate(t, &o, &off, &base);
+
+  long p = fwd_up(v, o, off, base, base + leaf_excess(v, o+1) + d - 1);
+
+  return (p >= 0) ? p : i;
+}
+
+int32_t dyn_bwd_search(dyn_tree* t, int32_t i, int32_t d) {
+  long o = i, off;
+  int32_t base;
+  dyn_node* v = locate(t, &o, &off, &base);
+
+  long p = bwd_up(v, o, off, base, base + leaf_excess(v, o+1) - d);
+
+  return (p >= 0) ? p : i;
+}
+
+int32_t dyn_rank_1(dyn_tree* t, int32_t i) {
+  return (i + 1 + dyn_sum(t, i))/2;
+}
+
+int32_t dyn_find_close(dyn_tree* t, int32_t i) {
+  long o = i, off;
+  int32_t base;
+  dyn_node* v = locate(t, &o, &off, &base);
+  if(!get_bit(v->words, o))
+    return i;
+
+  return fwd_up(v, o, off, base, base + leaf_excess(v, o+1) - 1);
+}
+
+int32_t dyn_find_open(dyn_tree* t, int32_t i) {
+  long o = i, off;
+  int32_t base;
+  dyn_node* v = locate(t, &o, &off, &base);
+  if(get_bit(v->words, o))
+    return i;
+
+  return bwd_up(v, o, off, base, base + leaf_excess(v, o+1));
+}
+
+// The excess before the opening parenthesis of the parent is the excess at
+// i minus 2, or minus 1 if i is a closing parenthesis. Like parent_t, it
+// returns the opening parenthesis of the node itself if it has no parent
+int32_t dyn_parent(dyn_tree* t, int32_t i) {
+  long o = i, off;
+  int32_t base;
+  dyn_node* v = locate(t, &o, &off, &base);
+  int32_t excess = base + leaf_excess(v, o+1);
+  int bit = get_bit(v->words, o);
+  long p = bwd_up(v, o, off, base, excess - 1 - bit);
+
+  if(p >= 0)
+    return p;
+
+  return bit ? i : dyn_find_open(t, i);
+}
+
+int32_t dyn_first_child(dyn_tree* t, int32_t i) {
+  if(i >= t->n-1 || !dyn_get_bit(t, i))
+    return -1;
+
+  return dyn_get_bit(t, i+1) ? i+1 : -1;
+}
+
+int32_t dyn_next_sibling(dyn_tree* t, int32_t i) {
+  if(i >= t->n-1 || !dyn_get_bit(t, i))
+    return -1;
+
+  i = dyn_find_close(t, i);
+
+  return (i < t->n-1 && dyn_get_bit(t, i+1)) ? i+1 : -1;
+}
+
+int32_t dyn_is_leaf(dyn_tree* t, int32_t i) {
+  if(i >= t->n-1 || !dyn_get_bit(t, i))
+    return 0;
+
+  return !dyn_get_bit(t, i+1);
+}
+
+int32_t dyn_depth(dyn_tree* t, int32_t i) {
+  return dyn_sum(t, i);
+}
+
+int32_t dyn_subtree_size(dyn_tree* t, int32_t i) {
+  i = dyn_find_open(t, i);
+
+  return (dyn_find_close(t, i) - i + 1)/2;
+}
+
+// The closing parentheses of the children are the minima of the excess
+// inside the node
+int32_t dyn_degree(dyn_tree* t, int32_t i) {
+  i = dyn_find_open(t, i);
+  int32_t close = dyn_find_close(t, i);
+  if(close == i+1)
+    return 0;
+
+  int32_t m = INT32_MAX, c = 0;
+  min_rec(t->root, 0, 0, i+1, close-1, &m, &c);
+
+  return c;
+}
+
+int32_t dyn_min_excess(dyn_tree* t, int32_t i, int32_t j) {
+  int32_t m, c, pos;
+
+  range_min(t, i, j, 0, &m, &c, &pos);
+  return m;
+}
+
+int32_t dyn_rmq(dyn_tree* t, int32_t i, int32_t j) {
+  int32_t m, c, pos;
+
+  range_min(t, i, j, 1, &m, &c, &pos);
+  return pos;
+}
+
+int32_t dyn_rmq_count(dyn_tree* t, int32_t i, int32_t j) {
+  int32_t m, c, pos;
+
+  range_min(t, i, j, 0, &m, &c, &pos);
+  return c;
+}
+
+int32_t dyn_rmq_select(dyn_tree* t, int32_t i, int32_t j, int32_t r) {
+  int32_t m, c, pos;
+
+  range_min(t, i, j, r, &m, &c, &pos);
+  return pos;
+}
+
+int32_t dyn_child(dyn_tree* t, int32_t i, int32_t r) {
+  i = dyn_find_open(t, i);
+
+  if(r < 1 || i >= t->n-1 || !dyn_get_bit(t, i+1))
+    return -1;
+  if(r == 1)
+    return i+1;
+
+  // Closing parenthesis of the (r-1)th child
+  int32_t close = dyn_find_close(t, i);
+  int32_t output = dyn_rmq_select(t, i+1, close-1, r-1);
+  if(output < 0 || output+1 == close)
+    return -1;
+
+  return output+1;
+}
+
+int32_t dyn_child_rank(dyn_tree* t, int32_t i) {
+  i = dyn_find_open(t, i);
+
+  if(i == 0) // Root
+    return 1;
+
+  int32_t p = dyn_parent(t, i);
+  if(p+1 == i) // First child
+    return 1;
+
+  return dyn_rmq_count(t, p+1, i-1)+1;
+}
+
+// See lca: the leftmost minimum of [i, j] is either i or the closing
+// parenthesis of a child of the lca
+int32_t dyn_lca(dyn_tree* t, int32_t i, int32_t j) {
+  i = dyn_find_open(t, i);
+  j = dyn_find_open(t, j);
+
+  if(i > j) {
+    int32_t tmp = i;
+    i = j;
+    j = tmp;
+  }
+
+  int32_t pos = dyn_rmq(t, i, j);
+  if(pos == i)
+    return i;
+
+  return dyn_parent(t, pos+1);
+}
+
+int32_t dyn_level_ancestor(dyn_tree* t, int32_t i, int32_t k) {
+  i = dyn_find_open(t, i);
+
+  if(k <= 0)
+    return (k == 0) ? i : -1;
+
+  int32_t output = dyn_bwd_search(t, i, k+1);
+  if(output == i) // There are less than k ancestors
+    return -1;
+
+  return output;
+}
@@ -0,0 +1,127 @@
+
+/******************************************************************************
+ * dynamic_tree.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef DYNAMIC_TREE_H
+#define DYNAMIC_TREE_H
+
+#include "succinct_tree.h"
+
+/*
+ * Dynamic balanced parentheses. The bits are stored in blocks of
+ * DYN_MIN_BITS to DYN_MAX_BITS bits, which are the leaves of an AVL tree
+ * (the dynamic min-max tree). Each node stores, for its range of bits, the
+ * total excess e, the minimum and maximum excess m and M, and the number of
+ * times n that the minimum is reached, relative to the start of the range.
+ * Inserting or deleting a parenthesis pair updates one or two blocks and
+ * their ancestors, splitting or merging blocks and rotating the tree when
+ * needed, in O(log n) time plus the size of a block.
+ *
+ * The queries follow the conventions of succinct_tree.h. The operations that
+ * are not provided can be answered by rebuilding a static rmMt with
+ * dyn_to_bits and st_create.
+ */
+
+// Target size of the blocks in bits, a multiple of 64
+#define DYN_BITS 1024
+#define DYN_MIN_BITS (DYN_BITS/2)
+#define DYN_MAX_BITS (2*DYN_BITS)
+
+typedef struct dyn_node_t {
+  struct dyn_node_t* left;
+  struct dyn_node_t* right;
+  struct dyn_node_t* parent;
+  int height; // 0 for the leaves
+  long len; // Number of bits
+  int32_t e, m, M, nm; // Excess, minimum, maximum and number of minima
+  word_t* words; // Bits of a leaf (NULL for internal nodes)
+} dyn_node;
+
+typedef struct {
+  long n; // Number of parentheses
+  dyn_node* root;
+} dyn_tree;
+
+// It builds the dynamic tree of the parentheses B[0..n-1], with the blocks
+// filled in parallel. B is not modified
+dyn_tree* dyn_create(BIT_ARRAY* B, long n);
+void dyn_free(dyn_tree* t);
+
+// It returns the current sequence of parentheses and stores its length in n
+BIT_ARRAY* dyn_to_bits(dyn_tree* t, long* n);
+
+/* Updates */
+
+// It inserts an opening parenthesis at position i and a closing parenthesis
+// at position j > i, both positions in the resulting sequence. The new node
+// is the parent of the nodes between them, which must be balanced (j = i+1
+// inserts a leaf)
+void insert_node(dyn_tree* t, int32_t i, int32_t j);
+
+// It deletes the node whose opening or closing parenthesis is at position i.
+// Its children become children of its parent. The root can only be deleted
+// if it has at most one child
+void delete_node(dyn_tree* t, int32_t i);
+
+/* Queries */
+
+int dyn_get_bit(dyn_tree* t, int32_t i);
+
+// Excess value at position i (see sum)
+int32_t dyn_sum(dyn_tree* t, int32_t i);
+
+// See fwd_search and bwd_search. They return i if there is no answer
+int32_t dyn_fwd_search(dyn_tree* t, int32_t i, int32_t d);
+int32_t dyn_bwd_search(dyn_tree* t, int32_t i, int32_t d);
+
+int32_t dyn_rank_1(dyn_tree* t, int32_t i);
+int32_t dyn_find_close(dyn_tree* t, int32_t i);
+int32_t dyn_find_open(dyn_tree* t, int32_t i);
+int32_t dyn_parent(dyn_tree* t, int32_t i);
+int32_t dyn_first_child(dyn_tree* t, int32_t i);
+int32_t dyn_next_sibling(dyn_tree* t, int32_t i);
+int32_t dyn_is_leaf(dyn_tree* t, int32_t i);
+int32_t dyn_depth(dyn_tree* t, int32_t i);
+int32_t dyn_subtree_size(dyn_tree* t, int32_t i);
+int32_t dyn_degree(dyn_tree* t, int32_t i);
+
+// Range minimum queries over the fields m and nm of the nodes (see
+// min_excess, rmq, rmq_count and rmq_select), in O(log n) time plus the size
+// of a block
+int32_t dyn_min_excess(dyn_tree* t, int32_t i, int32_t j);
+int32_t dyn_rmq(dyn_tree* t, int32_t i, int32_t j);
+int32_t dyn_rmq_count(dyn_tree* t, int32_t i, int32_t j);
+int32_t dyn_rmq_select(dyn_tree* t, int32_t i, int32_t j, int32_t r);
+
+// See child, child_rank, lca and level_ancestor
+int32_t dyn_child(dyn_tree* t, int32_t i, int32_t r);
+int32_t dyn_child_rank(dyn_tree* t, int32_t i);
+int32_t dyn_lca(dyn_tree* t, int32_t i, int32_t j);
+int32_t dyn_level_ancestor(dyn_tree* t, int32_t i, int32_t k);
+
+#endif // DYNAMIC_TREE_H
@@ -19,7 +19,7 @@ lookup_table* create_lookup_tables() {
   lookup_table* T = (lookup_table *)malloc(sizeof(lookup_table));
   
   //  int32_t x;
-  cilk_for (int32_t x = -8; x < 8; ++x) {
+  cilk_for (int32_t x = -8; x <= 8; ++x) {
     for (uint16_t w=0; w < 256; ++w) {
       uint16_t i = (x+8)<<8|w;
       T->near_fwd_pos[i] = 8;
@@ -69,6 +69,7 @@ lookup_table* create_lookup_tables() {
     int32_t min_excess_of_open_pos = 0;
     uint32_t ones = 0;
     T->min[w] = 8;
+    T->max[w] = -8;
     packed_mins[0] = 0x99999999U;
     packed_maxs[0] = 0x99999999U;
     uint16_t p;
@@ -76,9 +77,16 @@ lookup_table* create_lookup_tables() {
     for (p=0; p<8; ++p) {
       ones += (w&(1<<p))!=0;
       excess += 1-2*((w&(1<<p))==0);
+      if (excess < T->min[w])
+	T->min_count[w] = 0;
       if (excess <= T->min[w]) {
     	T->min[w] = excess;
     	T->min_pos_max[w] = p;
+	T->min_count[w]++;
+      }
+      if (excess > T->max[w]) {
+	T->max[w] = excess;
+	T->max_pos_min[w] = p;
       }
       if (excess < 0 && packed_mins[-excess-1] == 9) {
     	packed_mins[-excess-1] = p;
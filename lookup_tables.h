@@ -14,14 +14,14 @@ struct _lookup_table {
   // near_fwd_pos[(x+8)<<8 | w] contains the minimal position
   // p in [0..7] where the excess value x is reached, or 8
   // if x is not reached in w.
-  uint8_t near_fwd_pos[(8-(-8))*256];
+  uint8_t near_fwd_pos[(8-(-8)+1)*256];
   
   // Given an excess value of x in [-8,8] and a 8-bit
   // word w interpreted as parentheses sequence.
   // near_bwd_pos[(x+8)<<8 | w] contains the maximal position
   // p in [0..7] where the excess value x is reached, or 8
   // if x is not reached in w.
-  uint8_t near_bwd_pos[(8-(-8))*256];
+  uint8_t near_bwd_pos[(8-(-8)+1)*256];
   
   // Given a 8-bit word w. word_sum[w] contains the
   // excess value of w.
@@ -35,6 +35,20 @@ struct _lookup_table {
   // the maximal position p in w, where min[w] is
   // reached
   int8_t min_pos_max[256];
+
+  // Given a 8-bit word w. min_count[w] contains
+  // the number of positions p in w where min[w]
+  // is reached
+  int8_t min_count[256];
+
+  // Given a 8-bit word w. max[w] contains the
+  // maximal excess value in w.
+  int8_t max[256];
+
+  // Given a 8-bit word w. max_pos_min[w] contains
+  // the minimal position p in w, where max[w] is
+  // reached
+  int8_t max_pos_min[256];
   
   // Given an excess value x in [1,8] and a 8-bit
   // word w interpreted as parentheses sequence.
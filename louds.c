@@ -0,0 +1,191 @@
+
+/******************************************************************************
+ * louds.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "louds.h"
+#include "tree_arrays.h"
+#include "util.h"
+#include "basic.h"
+
+// st_create needs more than one chunk of bits
+#define LOUDS_MIN_BITS 258
+
+/*
+ * The breadth-first order is the order by depth and then by preorder. The
+ * nodes are split into blocks of consecutive preorder ranks, one per thread,
+ * and each block counts its nodes per depth. The depths of a block are in a
+ * range [lo, hi], and the sum of the lengths of these ranges is at most
+ * 2*nodes+blocks, because the depth grows by one at a time in preorder.
+ */
+BIT_ARRAY* st_to_louds(rmMt* st, int32_t** preorder, long* n) {
+  long nodes = st->n/2;
+  int32_t* depths = st_depth_array(st);
+  int32_t* degrees = st_degree_array(st);
+
+  unsigned int blocks = (nodes < threads) ? 1 : threads;
+  long per_block = (nodes + blocks - 1)/blocks;
+  int32_t* lo = (int32_t*)malloc(blocks*sizeof(int32_t));
+  int32_t* hi = (int32_t*)malloc(blocks*sizeof(int32_t));
+  long* base = (long*)malloc((blocks+1)*sizeof(long));
+
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, nodes);
+    lo[b] = INT32_MAX;
+    hi[b] = 0;
+    for(long v = first; v < last; v++) {
+      lo[b] = min(lo[b], depths[v]);
+      hi[b] = max(hi[b], depths[v]);
+    }
+  }
+
+  int32_t levels = 0;
+  base[0] = 0;
+  for(unsigned int b = 0; b < blocks; b++) {
+    base[b+1] = base[b] + ((hi[b] >= lo[b]) ? hi[b] - lo[b] + 1 : 0);
+    levels = max(levels, hi[b]);
+  }
+
+  // Number of nodes of each depth in each block
+  long* counts = (long*)calloc(base[blocks], sizeof(long));
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, nodes);
+    for(long v = first; v < last; v++)
+      counts[base[b] + depths[v] - lo[b]]++;
+  }
+
+  // Each count is replaced by the number of nodes of its depth in the
+  // previous blocks, and level[d] becomes the number of nodes of depth d.
+  // Then, level[d-1] is the number of nodes above the depth d
+  long* level = (long*)calloc(levels+1, sizeof(long));
+  for(unsigned int b = 0; b < blocks; b++)
+    for(int32_t d = lo[b]; d <= hi[b]; d++) {
+      long c = counts[base[b] + d - lo[b]];
+      counts[base[b] + d - lo[b]] = level[d];
+      level[d] += c;
+    }
+  prefix_sum(level, levels+1);
+
+  int32_t* order = (int32_t*)malloc(nodes*sizeof(int32_t));
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, nodes);
+    for(long v = first; v < last; v++) {
+      int32_t d = depths[v];
+      order[level[d-1] + counts[base[b] + d - lo[b]]++] = v;
+    }
+  }
+
+  free(depths);
+  free(lo);
+  free(hi);
+  free(base);
+  free(counts);
+  free(level);
+
+  // Number of ones up to each node in breadth-first order. The ones of the
+  // node k start at the position 2+k plus the ones of the previous nodes
+  long* sums = (long*)malloc(nodes*sizeof(long));
+  cilk_for(long k = 0; k < nodes; k++)
+    sums[k] = degrees[order[k]];
+  prefix_sum(sums, nodes);
+
+  *n = 2*nodes+1;
+  BIT_ARRAY* B = bit_array_create(*n);
+  bit_array_set_bit(B, 0);
+
+  cilk_for(unsigned int b = 0; b < blocks; b++) {
+    long first = b*per_block, last = min(first + per_block, nodes);
+    if(first < last) {
+      long from = 2 + first + sums[first] - degrees[order[first]];
+      long to = 2 + last + sums[last-1];
+
+      for(long k = first; k < last; k++) {
+	long pos = 2 + k + sums[k] - degrees[order[k]];
+	set_bit_range(B, pos, pos + degrees[order[k]], from, to);
+      }
+    }
+  }
+
+  free(degrees);
+  free(sums);
+
+  if(preorder)
+    *preorder = order;
+  else
+    free(order);
+
+  return B;
+}
+
+louds_t* louds_create(BIT_ARRAY* B, long n) {
+  louds_t* l = (louds_t*)malloc(sizeof(louds_t));
+  l->nodes = (n-1)/2;
+
+  // Zeros appended after the last node do not change the operations
+  if(n < LOUDS_MIN_BITS) {
+    bit_array_resize(B, LOUDS_MIN_BITS);
+    n = LOUDS_MIN_BITS;
+  }
+  l->st = st_create(B, n);
+
+  return l;
+}
+
+void free_louds(louds_t* l) {
+  st_free(l->st);
+  free(l);
+}
+
+// The node v is described by the bits that follow the (v+1)-th zero, and it
+// is the (v+1)-th one of the sequence (the first one is the root). So a one
+// at position p is the node p - zeros up to p, minus one for the root
+int32_t louds_parent(louds_t* l, int32_t v) {
+  if(v <= 0)
+    return -1;
+
+  return select_1(l->st, v+1) - v - 1;
+}
+
+int32_t louds_child(louds_t* l, int32_t v, int32_t t) {
+  if(v < 0 || t < 1)
+    return -1;
+
+  int32_t p = select_0(l->st, v+1);
+  if(t >= next_0(l->st, p) - p)
+    return -1;
+
+  return p + t - v - 1;
+}
+
+int32_t louds_degree(louds_t* l, int32_t v) {
+  int32_t p = select_0(l->st, v+1);
+
+  return next_0(l->st, p) - p - 1;
+}
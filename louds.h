@@ -0,0 +1,69 @@
+
+/******************************************************************************
+ * louds.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef LOUDS_H
+#define LOUDS_H
+
+#include "succinct_tree.h"
+
+/*
+ * Level-order unary degree sequence (LOUDS). The nodes are numbered in
+ * breadth-first order (the root is 0), and the sequence is "10" followed by
+ * the degree of each node in unary, d ones and a zero. The rank and select
+ * operations are answered by an rmMt built over the sequence.
+ */
+
+typedef struct {
+  long nodes; // Number of nodes
+  rmMt* st; // rmMt of the LOUDS sequence
+} louds_t;
+
+// It returns the LOUDS sequence of the tree of st and stores its length in
+// n. If preorder is not NULL, it stores in *preorder the preorder rank of
+// each node. The nodes are sorted by depth with a parallel counting sort
+// over the levels, and each one writes its degree at the position given by
+// a parallel prefix sum of the degrees in breadth-first order
+BIT_ARRAY* st_to_louds(rmMt* st, int32_t** preorder, long* n);
+
+// Construction of the LOUDS representation (st_create over the sequence
+// returned by st_to_louds)
+louds_t* louds_create(BIT_ARRAY* B, long n);
+void free_louds(louds_t* l);
+
+// It returns the parent of the node v, or -1 for the root
+int32_t louds_parent(louds_t* l, int32_t v);
+
+// It returns the t-th child of the node v (t >= 1), or -1 if it does not
+// exist
+int32_t louds_child(louds_t* l, int32_t v, int32_t t);
+
+// It returns the number of children of the node v
+int32_t louds_degree(louds_t* l, int32_t v);
+
+#endif // LOUDS_H
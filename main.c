@@ -28,25 +28,113 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include <sys/time.h>
 #include <time.h>
 
 #include "succinct_tree.h"
+#include "bp_input.h"
+#include "cartesian_tree.h"
+#include "louds.h"
+#include "dfuds.h"
 #include "util.h"
 
+static void usage(char* name) {
+  fprintf(stderr, "Usage: %s [-f bp|parents|edges|xml|json|newick|lcp] [-s] "
+	  "<input>\n", name);
+  fprintf(stderr, "  -f bp: parentheses sequence (default)\n");
+  fprintf(stderr, "  -f parents: parent array, binary file of 32-bit integers "
+	  "(-1 for the root)\n");
+  fprintf(stderr, "  -f edges: edge list, text file with one \"parent child\" "
+	  "per line\n");
+  fprintf(stderr, "  -f xml, -f json: structure of a document (elements, or "
+	  "objects and arrays)\n");
+  fprintf(stderr, "  -f newick: phylogenetic tree in Newick format\n");
+  fprintf(stderr, "  -f lcp: suffix tree of an LCP array, binary file of "
+	  "32-bit integers\n");
+  fprintf(stderr, "  -s: children sorted by identifier instead of the order of "
+	  "the edge list\n");
+  fprintf(stderr, "  -o <prefix>: the parentheses, the LOUDS and the DFUDS "
+	  "sequences are saved in <prefix>.bp, <prefix>.louds and "
+	  "<prefix>.dfuds\n");
+  exit(EXIT_FAILURE);
+}
+
+// It saves B in the file <prefix><suffix> (see bit_array_save)
+static void save_bits(BIT_ARRAY* B, const char* prefix, const char* suffix) {
+  char* fn = (char*)malloc(strlen(prefix) + strlen(suffix) + 1);
+  sprintf(fn, "%s%s", prefix, suffix);
+
+  FILE* fp = fopen(fn, "w");
+  if (!fp) {
+    fprintf(stderr, "Error opening file \"%s\".\n", fn);
+    exit(-1);
+  }
+  bit_array_save(B, fp);
+  fclose(fp);
+  free(fn);
+}
+
 int main(int argc, char** argv) {
 
   struct timespec stime, etime;
   double time;
 
-  if(argc < 2) {
-    fprintf(stderr, "Usage: %s <input parentheses sequence>\n", argv[0]);
-    exit(EXIT_FAILURE);
+  const char* format = "bp";
+  edge_order order = EDGE_ORDER_INPUT;
+  const char* output = NULL;
+  int opt;
+
+  while((opt = getopt(argc, argv, "f:so:")) != -1) {
+    if(opt == 'f')
+      format = optarg;
+    else if(opt == 's')
+      order = EDGE_ORDER_ID;
+    else if(opt == 'o')
+      output = optarg;
+    else
+      usage(argv[0]);
   }
 
+  if(optind >= argc)
+    usage(argv[0]);
+
+  char* input = argv[optind];
   long n;
+  BIT_ARRAY *B;
 
-  BIT_ARRAY *B = parentheses_to_bits(argv[1], &n);
+  if(!strcmp(format, "bp"))
+    B = parentheses_to_bits(input, &n);
+  else if(!strcmp(format, "parents")) {
+    long nodes;
+    int32_t* parents = read_parent_array(input, &nodes);
+    B = parents_to_bits(parents, nodes, &n);
+    free(parents);
+  }
+  else if(!strcmp(format, "edges")) {
+    long m;
+    int32_t* edges = read_edge_list(input, &m);
+    B = edges_to_bits(edges, m, order, &n);
+    free(edges);
+  }
+  else if(!strcmp(format, "xml"))
+    B = document_to_bits(input, DOC_XML, &n);
+  else if(!strcmp(format, "json"))
+    B = document_to_bits(input, DOC_JSON, &n);
+  else if(!strcmp(format, "newick")) {
+    newick_data data;
+    B = newick_to_bits(input, &data, &n);
+    free_newick(&data);
+  }
+  else if(!strcmp(format, "lcp")) {
+    long m;
+    int32_t* lcp = read_lcp_array(input, &m);
+    B = suffix_tree_lcp(lcp, m, &n);
+    free(lcp);
+  }
+  else
+    usage(argv[0]);
 
 #ifdef MALLOC_COUNT
   size_t s_total_memory = malloc_count_total();
@@ -64,7 +152,7 @@ int main(int argc, char** argv) {
 #ifdef MALLOC_COUNT
   size_t e_total_memory = malloc_count_total();
   size_t e_current_memory = malloc_count_current();
-  printf("%s,%ld,%zu,%zu,%zu,%zu,%zu\n", argv[1], n, s_total_memory,
+  printf("%s,%ld,%zu,%zu,%zu,%zu,%zu\n", input, n, s_total_memory,
   e_total_memory, malloc_count_peak(), s_current_memory, e_current_memory);
   
 #else
@@ -74,8 +162,19 @@ int main(int argc, char** argv) {
   }
   
   time = (etime.tv_sec - stime.tv_sec) + (etime.tv_nsec - stime.tv_nsec) / 1000000000.0;
-  printf("%d,%s,%lu,%lf\n", threads, argv[1], n, time);
+  printf("%d,%s,%lu,%lf\n", threads, input, n, time);
 #endif
 
+  if(output) {
+    long louds_n, dfuds_n;
+    BIT_ARRAY* louds = st_to_louds(st, NULL, &louds_n);
+    BIT_ARRAY* dfuds = st_to_dfuds(st, &dfuds_n);
+    save_bits(B, output, ".bp");
+    save_bits(louds, output, ".louds");
+    save_bits(dfuds, output, ".dfuds");
+    bit_array_free(louds);
+    bit_array_free(dfuds);
+  }
+
   return EXIT_SUCCESS;
 }
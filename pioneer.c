@@ -0,0 +1,301 @@
+
+/******************************************************************************
+ * pioneer.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdlib.h>
+
+#include "pioneer.h"
+#include "util.h"
+#include "basic.h"
+
+/*
+ * Construction
+ */
+
+// The matches of the far opening parentheses far[lo..hi] of a chunk are
+// decreasing. Given the matches mlo and mhi of far[lo] and far[hi], it appends
+// to 'out' the parentheses of far(lo..hi] that start a new run (i.e. their
+// matches are in a different chunk than the match of the previous one)
+static void open_runs(rmMt* st, int32_t* far, int lo, int hi, int32_t mlo,
+		      int32_t mhi, int32_t* out, int32_t* out_match, int* cnt) {
+  if(mlo/st->s == mhi/st->s)
+    return;
+
+  if(hi == lo+1) {
+    out[*cnt] = far[hi];
+    out_match[(*cnt)++] = mhi;
+    return;
+  }
+
+  int mid = (lo+hi)/2;
+  int32_t mmid = fwd_search(st, far[mid], 0);
+  open_runs(st, far, lo, mid, mlo, mmid, out, out_match, cnt);
+  open_runs(st, far, mid, hi, mmid, mhi, out, out_match, cnt);
+}
+
+// Counterpart of open_runs for the far closing parentheses far[lo..hi]. It
+// appends the parentheses of far[lo..hi) that end a run
+static void close_runs(rmMt* st, int32_t* far, int lo, int hi, int32_t mlo,
+		       int32_t mhi, int32_t* out, int32_t* out_match, int* cnt) {
+  if(mlo/st->s == mhi/st->s)
+    return;
+
+  if(hi == lo+1) {
+    out[*cnt] = far[lo];
+    out_match[(*cnt)++] = mlo;
+    return;
+  }
+
+  int mid = (lo+hi)/2;
+  int32_t mmid = bwd_search(st, far[mid], 0);
+  close_runs(st, far, lo, mid, mlo, mmid, out, out_match, cnt);
+  close_runs(st, far, mid, hi, mmid, mhi, out, out_match, cnt);
+}
+
+// It computes the opening and closing pioneers of a chunk, sorted by
+// position. Each output array must have space for st->s elements
+static void chunk_pioneers(rmMt* st, long chunk, int32_t* open,
+			   int32_t* open_match, int* num_open, int32_t* close,
+			   int32_t* close_match, int* num_close) {
+  int32_t far_open[st->s], far_close[st->s];
+  int nfo = 0, nfc = 0;
+  int32_t end = min((chunk+1)*st->s, st->n);
+
+  // The parentheses without a match inside the chunk are far
+  for(int32_t j = chunk*st->s; j < end; j++) {
+    if(bit_array_get_bit(st->bit_array,j))
+      far_open[nfo++] = j;
+    else if(nfo > 0)
+      nfo--;
+    else
+      far_close[nfc++] = j;
+  }
+
+  *num_open = 0;
+  if(nfo > 0) {
+    int32_t mfirst = fwd_search(st, far_open[0], 0);
+    int32_t mlast = (nfo > 1) ? fwd_search(st, far_open[nfo-1], 0) : mfirst;
+
+    open[0] = far_open[0];
+    open_match[0] = mfirst;
+    *num_open = 1;
+    if(nfo > 1)
+      open_runs(st, far_open, 0, nfo-1, mfirst, mlast, open, open_match,
+		num_open);
+  }
+
+  *num_close = 0;
+  if(nfc > 0) {
+    int32_t mfirst = bwd_search(st, far_close[0], 0);
+    int32_t mlast = (nfc > 1) ? bwd_search(st, far_close[nfc-1], 0) : mfirst;
+
+    if(nfc > 1)
+      close_runs(st, far_close, 0, nfc-1, mfirst, mlast, close, close_match,
+		 num_close);
+    close[*num_close] = far_close[nfc-1];
+    close_match[(*num_close)++] = mlast;
+  }
+}
+
+void st_create_pioneers(rmMt* st) {
+  pioneer* P = (pioneer*)malloc(sizeof(pioneer));
+  long num_chunks = st->num_chunks;
+  long words_per_chunk = st->s >> logW;
+  long num_words = (st->n + word_size - 1) >> logW;
+
+  P->bits = bit_array_create(st->n);
+  P->rank_chunk = (int32_t*)calloc(num_chunks+1, sizeof(int32_t));
+  P->rank_word = (uint8_t*)calloc(num_chunks*words_per_chunk, sizeof(uint8_t));
+
+  /*
+   * STEP 1: Each chunk marks its pioneers and their matches (the matches are
+   * in other chunks, so they are set atomically)
+   */
+  cilk_for(long chunk = 0; chunk < num_chunks; chunk++) {
+    int32_t open[st->s], open_match[st->s], close[st->s], close_match[st->s];
+    int no, nc;
+
+    chunk_pioneers(st, chunk, open, open_match, &no, close, close_match, &nc);
+    for(int k = 0; k < no; k++) {
+      parallel_or_bit_array_set_bit(P->bits, open[k]);
+      parallel_or_bit_array_set_bit(P->bits, open_match[k]);
+    }
+    for(int k = 0; k < nc; k++) {
+      parallel_or_bit_array_set_bit(P->bits, close[k]);
+      parallel_or_bit_array_set_bit(P->bits, close_match[k]);
+    }
+  }
+
+  /*
+   * STEP 2: Rank directory
+   */
+  cilk_for(long chunk = 0; chunk < num_chunks; chunk++) {
+    int32_t count = 0;
+
+    for(long w = chunk*words_per_chunk; w < (chunk+1)*words_per_chunk; w++) {
+      P->rank_word[w] = count;
+      if(w < num_words)
+	count += __builtin_popcountl(P->bits->words[w]);
+    }
+    P->rank_chunk[chunk+1] = count;
+  }
+
+  for(long chunk = 0; chunk < num_chunks; chunk++)
+    P->rank_chunk[chunk+1] += P->rank_chunk[chunk];
+  P->num = P->rank_chunk[num_chunks];
+
+  /*
+   * STEP 3: Matches of the pioneers
+   */
+  P->match = (int32_t*)malloc(P->num*sizeof(int32_t));
+  cilk_for(long chunk = 0; chunk < num_chunks; chunk++) {
+    int32_t k = P->rank_chunk[chunk];
+
+    for(long w = chunk*words_per_chunk; w < (chunk+1)*words_per_chunk &&
+	  w < num_words; w++)
+      for(word_t bits = P->bits->words[w]; bits; bits &= bits-1) {
+	int32_t p = (w << logW) + ctz_word(bits);
+	P->match[k++] = bit_array_get_bit(st->bit_array, p) ?
+	  fwd_search(st, p, 0) : bwd_search(st, p, 0);
+      }
+  }
+
+  /*
+   * STEP 4: Enclosing pairs in the pioneer BP, with a stack over its O(n/s)
+   * parentheses
+   */
+  P->enc = (int32_t*)malloc(P->num*sizeof(int32_t));
+  int32_t* stack = (int32_t*)malloc(P->num*sizeof(int32_t));
+  int32_t top = 0, k = 0;
+
+  for(long w = 0; w < num_words; w++)
+    for(word_t bits = P->bits->words[w]; bits; bits &= bits-1) {
+      int32_t p = (w << logW) + ctz_word(bits);
+      if(bit_array_get_bit(st->bit_array, p))
+	P->enc[k++] = stack[top++] = p;
+      else {
+	top--;
+	P->enc[k++] = (top > 0) ? stack[top-1] : -1;
+      }
+    }
+  free(stack);
+
+  st->pioneers = P;
+}
+
+void st_free_pioneers(rmMt* st) {
+  pioneer* P = st->pioneers;
+
+  if(P) {
+    bit_array_free(P->bits);
+    free(P->rank_chunk);
+    free(P->rank_word);
+    free(P->match);
+    free(P->enc);
+    free(P);
+  }
+  st->pioneers = NULL;
+}
+
+unsigned long size_pioneers(rmMt* st) {
+  pioneer* P = st->pioneers;
+
+  if(!P)
+    return 0;
+
+  return sizeof(pioneer) + ((st->n + word_size - 1) >> logW)*sizeof(word_t) +
+    (st->num_chunks+1)*sizeof(int32_t) +
+    st->num_chunks*(st->s >> logW)*sizeof(uint8_t) +
+    2*P->num*sizeof(int32_t);
+}
+
+/*
+ * Queries
+ */
+
+// Number of pioneers in the positions [0,i]
+static inline int32_t rank_pioneers(rmMt* st, int32_t i) {
+  pioneer* P = st->pioneers;
+  word_t w = P->bits->words[i >> logW] &
+    (((word_t)2 << (i & (word_size-1))) - 1);
+
+  return P->rank_chunk[i/st->s] + P->rank_word[i >> logW] +
+    __builtin_popcountl(w);
+}
+
+int32_t pioneer_find_close(rmMt* st, int32_t i) {
+  if(bit_array_get_bit(st->bit_array,i) == 0)
+    return i;
+
+  int32_t excess = sum(st, i);
+  int32_t output = check_leaf_r(st, i, excess-1, excess);
+  if(output > i)
+    return output;
+
+  // The last pioneer up to i is the pioneer of i, and the match of i is in
+  // the chunk of its match
+  long chunk = st->pioneers->match[rank_pioneers(st, i) - 1]/st->s;
+
+  return check_sibling_r(st, chunk*st->s, excess-1);
+}
+
+int32_t pioneer_find_open(rmMt* st, int32_t i) {
+  if(bit_array_get_bit(st->bit_array,i) == 1)
+    return i;
+
+  int32_t excess = sum(st, i);
+  int32_t output = check_leaf_l(st, i, excess, excess);
+  if(output < i)
+    return output;
+
+  // The first pioneer from i on
+  long chunk = st->pioneers->match[rank_pioneers(st, i-1)]/st->s;
+
+  return check_sibling_l(st, chunk*st->s, excess, 0);
+}
+
+int32_t pioneer_enclose(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = pioneer_find_open(st, i);
+
+  int32_t excess = sum(st, i);
+  int32_t output = check_leaf_l(st, i, excess+2, excess);
+  if(output < i || i == 0)
+    return output;
+
+  // The nearest pair of the pioneer BP that encloses i starts in the chunk of
+  // the answer. It is the pair enclosing the position after the last pioneer
+  // before i
+  int32_t k = rank_pioneers(st, i-1) - 1;
+  int32_t p = (k >= 0) ? st->pioneers->enc[k] : -1;
+
+  if(p < 0) // Root
+    return i;
+
+  return check_sibling_l(st, (p/st->s)*st->s, excess, 2);
+}
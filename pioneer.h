@@ -0,0 +1,84 @@
+
+/******************************************************************************
+ * pioneer.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef PIONEER_H
+#define PIONEER_H
+
+#include "succinct_tree.h"
+
+/*
+ * Directory of pioneers (Jacobson; Geary, Rahman, Raman and Raman) for
+ * find_close, find_open and enclose in constant time. The blocks are the
+ * chunks of the rmMt. A parenthesis is far if its match is in another chunk.
+ * The far opening (closing) parentheses of a chunk form runs of consecutive
+ * parentheses whose matches are in the same chunk; the first (last)
+ * parenthesis of each run is an opening (closing) pioneer. The pioneers and
+ * their matches (the pioneer family) form a balanced sequence of O(n/s)
+ * parentheses, the pioneer BP.
+ *
+ * The pioneers are marked in a bitmap of n bits with a two-level rank
+ * directory, so the pioneer of a far parenthesis is found with one rank, and
+ * its match is stored explicitly. The match of the far parenthesis is then
+ * found by scanning the chunk of the match of its pioneer. enclose uses the
+ * nearest pair of the pioneer BP that encloses the query, which is
+ * tabulated for every pioneer (the last level of the recursion on the
+ * pioneer BP).
+ *
+ * If the code is compiled with -DPIONEER, st_create builds the directory and
+ * find_close, find_open and parent_t use it.
+ */
+
+struct pioneer_t {
+  int32_t num;          // Number of pioneers (including their matches)
+  BIT_ARRAY* bits;      // n bits, set at the pioneers
+  int32_t* rank_chunk;  // num_chunks+1, number of pioneers before each chunk
+  uint8_t* rank_word;   // Number of pioneers before each word of its chunk
+  int32_t* match;       // Match of each pioneer
+  int32_t* enc;         // Opening parenthesis of the nearest pair of the
+                        // pioneer BP that encloses the position after each
+                        // pioneer (-1 if none)
+};
+
+typedef struct pioneer_t pioneer;
+
+// It builds the directory of pioneers of st (st->pioneers)
+void st_create_pioneers(rmMt* st);
+
+// It frees the directory of pioneers of st, if any
+void st_free_pioneers(rmMt* st);
+
+// Size in bytes of the directory of pioneers
+unsigned long size_pioneers(rmMt* st);
+
+// Counterparts of find_close, find_open and parent_t using the directory
+int32_t pioneer_find_close(rmMt* st, int32_t i);
+int32_t pioneer_find_open(rmMt* st, int32_t i);
+int32_t pioneer_enclose(rmMt* st, int32_t i);
+
+#endif // PIONEER_H
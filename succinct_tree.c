@@ -27,12 +27,15 @@
  * IN THE SOFTWARE.
  *****************************************************************************/
 
+#include <time.h>
+
 #include "lookup_tables.h"
 #include "binary_trees.h"
 #include "succinct_tree.h"
 #include "bit_array.h"
 #include "util.h"
 #include "basic.h"
+#include "pioneer.h"
 
 /* ASSUMPTIONS:
  * - s = 256 (8 bits) (Following the sdsl/libcds implementations)
@@ -40,6 +43,11 @@
  * - Each thread has to process at least one chunk with parentheses (Problem with n <= s)
  */
 
+// It returns the 8 bits starting at position j (j must be a multiple of 8)
+static inline int32_t get_byte(rmMt* st, int32_t j) {
+  return ((st->bit_array)->words[j>>logW] >> (j&(word_size-1))) & 0xFF;
+}
+
 rmMt* init_rmMt(unsigned long n) {
   rmMt* st = (rmMt*)malloc(sizeof(rmMt));
   st->s = 256;
@@ -48,6 +56,10 @@ rmMt* init_rmMt(unsigned long n) {
   st->num_chunks = ceil((double)n/st->s);
   st->height = ceil(log(st->num_chunks)/log(st->k)); // heigh = logk(num_chunks), Heigh of the min-max tree
   st->internal_nodes = (pow(st->k,st->height)-1)/(st->k-1); // Number of internal nodes;
+  st->l_prime = NULL; // See st_create_leaves
+  st->e_delta = NULL; // See st_update_range
+  st->pioneers = NULL; // See st_create_pioneers
+  st->scan_chunks = SCAN_CHUNKS; // See st_calibrate
 
   return st;
 }
@@ -61,6 +73,34 @@ void print_rmMt(rmMt* st) {
   fprintf(stderr, "Number of internal nodes: %u\n", st->internal_nodes);
 }
 
+/*
+ * It computes the values m', M' and n' of the internal node 'pos' from the
+ * values of its children. Nodes of the complete k-ary tree that do not cover
+ * any chunk keep the neutral values m'=INT32_MAX, M'=INT32_MIN and n'=0, so
+ * they are never selected by the searches on the min-max tree.
+ */
+static void compute_internal_node(rmMt* st, unsigned int pos, unsigned int total_chunks) {
+  unsigned int lchild = pos*st->k+1, rchild = (pos+1)*st->k; // Range of children of 'node' in the final array
+  depth_t min = INT32_MAX, max = INT32_MIN;
+  int32_t num_mins = 0;
+
+  for(unsigned int child = lchild; (child <= rchild) && (child < total_chunks); child++) {
+    if(st->m_prime[child] < min) {
+      min = st->m_prime[child];
+      num_mins = st->n_prime[child];
+    }
+    else if(st->m_prime[child] == min)
+      num_mins += st->n_prime[child];
+
+    if(st->M_prime[child] > max)
+      max = st->M_prime[child];
+  }
+
+  st->m_prime[pos] = min;
+  st->M_prime[pos] = max;
+  st->n_prime[pos] = num_mins;
+}
+
 rmMt* st_create(BIT_ARRAY* bit_array, unsigned long n) {
   rmMt* st = init_rmMt(n);
   /* print_rmMt(st); */
@@ -70,7 +110,7 @@ rmMt* st_create(BIT_ARRAY* bit_array, unsigned long n) {
   st->m_prime = (depth_t*)calloc(st->num_chunks + st->internal_nodes,sizeof(depth_t));
   // num_chunks leaves plus internal nodes
   st->M_prime = (depth_t*)calloc(st->num_chunks + st->internal_nodes,sizeof(depth_t));  
-  st->n_prime = (int16_t*)calloc(st->num_chunks + st->internal_nodes,sizeof(int16_t));
+  st->n_prime = (int32_t*)calloc(st->num_chunks + st->internal_nodes,sizeof(int32_t));
   st->bit_array = bit_array;
   
   if(st->s >= n){
@@ -107,7 +147,7 @@ rmMt* st_create(BIT_ARRAY* bit_array, unsigned long n) {
 
     // Each thread traverses their chunks
     for(chunk = 0; chunk < chunk_limit; chunk++) {
-      int16_t num_mins = 1; // Number of occurrences of the minimum value in the chunk
+      int32_t num_mins = 1; // Number of occurrences of the minimum value in the chunk
       unsigned int llimit = 0, ulimit = 0;
       unsigned int global_chunk = thread*chunks_per_thread+chunk;
       
@@ -226,28 +266,8 @@ rmMt* st_create(BIT_ARRAY* bit_array, unsigned long n) {
       for(unsigned int node = 0; node < num_curr_nodes; node++) {
   	unsigned int pos = pow(st->k,lvl)-1 + node + subtree*num_curr_nodes;// Position in the final array of 'node'.
   									    //Note: It should be less than the offset
-  	unsigned int lchild = pos*st->k+1, rchild = (pos+1)*st->k; //Range of children of 'node' in the final array
-	
-  	/* for(unsigned int child = lchild; (child <= rchild) && (child < st->num_chunks); child++) { */
-  	for(unsigned int child = lchild; (child <= rchild) && (child <
-  	total_chunks); child++) {	  
-  	  if(child == lchild){// first time
-  	    st->m_prime[pos] = st->m_prime[child];
-  	    st->M_prime[pos] = st->M_prime[child];
-  	    st->n_prime[pos] = st->n_prime[child];
-  	  }
-  	  else {
-  	    if(st->m_prime[child] < st->m_prime[pos]) {
-  	      st->m_prime[pos] = st->m_prime[child];
-  	      st->n_prime[pos] = 1;
-	    }
-	    else if(st->m_prime[child] == st->m_prime[pos])
-	      st->n_prime[pos]++;
-	    
-  	    if(st->M_prime[child] > st->M_prime[pos])
-  	      st->M_prime[pos] = st->M_prime[child];
-  	  }
-  	}
+
+  	compute_internal_node(st, pos, total_chunks);
       }
     }
   }
@@ -255,32 +275,11 @@ rmMt* st_create(BIT_ARRAY* bit_array, unsigned long n) {
   for(int lvl=p_level-1; lvl >= 0 ; lvl--){ // O(num_threads)
     
     unsigned int num_curr_nodes = pow(st->k, lvl); // Number of nodes at curr_level level that belong to the subtree
-    unsigned int node = 0, child = 0;
+    unsigned int node = 0;
     
     for(node = 0; node < num_curr_nodes; node++) {
       unsigned int pos = (pow(st->k,lvl)-1)/(st->k-1) + node; // Position in the final array of 'node'
-      unsigned int lchild = pos*st->k+1, rchild = (pos+1)*st->k; // Range of children of 'node' in the final array
-      for(child = lchild; child <= rchild; child++){
-	if(st->m_prime[child] == st->M_prime[child])
-	  continue;
-	
-	if(child == lchild) { // first time
-	  st->m_prime[pos] = st->m_prime[child];
-	  st->M_prime[pos] = st->M_prime[child];
-	  st->n_prime[pos] = st->n_prime[child];
-	}
-	else {
-	  if(st->m_prime[child] < st->m_prime[pos]) {
-	    st->m_prime[pos] = st->m_prime[child];
-  	    st->n_prime[pos] = 1;
-	  }
-	  else if(st->m_prime[child] == st->m_prime[pos])
-	    st->n_prime[pos]++;
-
-	  if(st->M_prime[child] > st->M_prime[pos])
-	    st->M_prime[pos] = st->M_prime[child];
-	}
-      }
+      compute_internal_node(st, pos, total_chunks);
     }
   }
   
@@ -290,9 +289,190 @@ rmMt* st_create(BIT_ARRAY* bit_array, unsigned long n) {
 
   T = create_lookup_tables();
 
+#ifdef PIONEER
+  /*
+   * STEP 4: Directory of pioneers
+   */
+  st_create_pioneers(st);
+#endif
+
   return st;
 }
 
+/*
+ * Incremental updates (see st_update_range)
+ */
+
+// Pending shift of the excess values of a chunk, the prefix sum of the
+// Fenwick tree e_delta
+static depth_t chunk_shift(rmMt* st, unsigned long chunk) {
+  depth_t shift = 0;
+
+  if(st->e_delta)
+    for(unsigned long i = chunk+1; i > 0; i -= i & -i)
+      shift += st->e_delta[i];
+
+  return shift;
+}
+
+// It shifts the excess values of the chunks from 'chunk' on by delta
+static void add_shift(rmMt* st, unsigned long chunk, depth_t delta) {
+  if(!st->e_delta)
+    st->e_delta = (depth_t*)calloc(st->num_chunks+1, sizeof(depth_t));
+
+  for(unsigned long i = chunk+1; i <= st->num_chunks; i += i & -i)
+    st->e_delta[i] += delta;
+}
+
+// First chunk covered by the node pos of the min-max tree (it is not smaller
+// than num_chunks if the node does not cover any chunk)
+static unsigned long first_chunk(rmMt* st, unsigned long pos) {
+  while(pos < st->internal_nodes)
+    pos = pos*st->k + 1;
+
+  return pos - st->internal_nodes;
+}
+
+// Like compute_internal_node, with the values of each node relative to the
+// pending shift of its first chunk
+static void update_internal_node(rmMt* st, unsigned long pos) {
+  unsigned long total_chunks = st->internal_nodes + st->num_chunks;
+
+  if(!st->e_delta) {
+    compute_internal_node(st, pos, total_chunks);
+    return;
+  }
+
+  unsigned long chunk = first_chunk(st, pos);
+  if(chunk >= st->num_chunks)
+    return;
+
+  depth_t min = INT32_MAX, max = INT32_MIN;
+  int32_t num_mins = 0;
+  for(unsigned long child = pos*st->k+1;
+      child <= (pos+1)*st->k && child < total_chunks; child++) {
+    unsigned long child_chunk = first_chunk(st, child);
+    if(child_chunk >= st->num_chunks)
+      continue;
+
+    depth_t shift = chunk_shift(st, child_chunk);
+    if(st->m_prime[child] + shift < min) {
+      min = st->m_prime[child] + shift;
+      num_mins = st->n_prime[child];
+    }
+    else if(st->m_prime[child] + shift == min)
+      num_mins += st->n_prime[child];
+
+    if(st->M_prime[child] + shift > max)
+      max = st->M_prime[child] + shift;
+  }
+
+  depth_t shift = chunk_shift(st, chunk);
+  st->m_prime[pos] = min - shift;
+  st->M_prime[pos] = max - shift;
+  st->n_prime[pos] = num_mins;
+}
+
+// It computes e', m', M' and n' of a chunk from the excess before it
+static void compute_chunk(rmMt* st, unsigned long chunk, depth_t excess,
+			  depth_t* e, depth_t* m, depth_t* M, int32_t* n) {
+  unsigned long i = chunk*st->s, to = min((chunk+1)*st->s, st->n);
+  depth_t min = INT32_MAX, max = INT32_MIN;
+  int32_t num_mins = 0;
+
+  for(; i + 8 <= to; i += 8) {
+    int w = ((st->bit_array)->words[i>>logW] >> (i&(word_size-1))) & 0xFF;
+    if(excess + T->min[w] < min) {
+      min = excess + T->min[w];
+      num_mins = T->min_count[w];
+    }
+    else if(excess + T->min[w] == min)
+      num_mins += T->min_count[w];
+    if(excess + T->max[w] > max)
+      max = excess + T->max[w];
+    excess += T->word_sum[w];
+  }
+  for(; i < to; i++) {
+    excess += 2*bit_array_get_bit(st->bit_array, i) - 1;
+    if(excess < min) {
+      min = excess;
+      num_mins = 1;
+    }
+    else if(excess == min)
+      num_mins++;
+    if(excess > max)
+      max = excess;
+  }
+
+  *e = excess;
+  *m = min;
+  *M = max;
+  *n = num_mins;
+}
+
+void st_update_range(rmMt* st, unsigned long from, unsigned long to) {
+  if(from > to || to >= st->n) {
+    fprintf(stderr, "Error: invalid range [%lu, %lu] (n: %lu)\n", from, to,
+	    st->n);
+    exit(EXIT_FAILURE);
+  }
+
+  st_free_pioneers(st);
+  free(st->l_prime);
+  st->l_prime = NULL;
+
+  unsigned long first = from/st->s, last = to/st->s;
+  depth_t old_excess = st->e_prime[last] + chunk_shift(st, last);
+  depth_t excess = first ? st->e_prime[first-1] + chunk_shift(st, first-1) : 0;
+
+  for(unsigned long chunk = first; chunk <= last; chunk++) {
+    unsigned long leaf = st->internal_nodes + chunk;
+    depth_t shift = chunk_shift(st, chunk), m, M;
+
+    compute_chunk(st, chunk, excess, &excess, &m, &M, &st->n_prime[leaf]);
+    st->e_prime[chunk] = excess - shift;
+    st->m_prime[leaf] = m - shift;
+    st->M_prime[leaf] = M - shift;
+  }
+
+  if(excess != old_excess && last < st->num_chunks-1)
+    add_shift(st, last+1, excess - old_excess);
+
+  // Ancestors of the chunks, level by level. The nodes that cover the first
+  // chunk with a new shift are ancestors of the last chunk
+  unsigned long lo = st->internal_nodes + first, hi = st->internal_nodes + last;
+  while(lo > 0) {
+    lo = (lo-1)/st->k;
+    hi = (hi-1)/st->k;
+    cilk_for(unsigned long pos = lo; pos <= hi; pos++)
+      update_internal_node(st, pos);
+  }
+}
+
+void st_flush_updates(rmMt* st) {
+  if(!st->e_delta)
+    return;
+
+  cilk_for(unsigned long chunk = 0; chunk < st->num_chunks; chunk++) {
+    depth_t shift = chunk_shift(st, chunk);
+    st->e_prime[chunk] += shift;
+    st->m_prime[st->internal_nodes + chunk] += shift;
+    st->M_prime[st->internal_nodes + chunk] += shift;
+  }
+
+  cilk_for(unsigned long pos = 0; pos < st->internal_nodes; pos++) {
+    unsigned long chunk = first_chunk(st, pos);
+    if(chunk < st->num_chunks) {
+      depth_t shift = chunk_shift(st, chunk);
+      st->m_prime[pos] += shift;
+      st->M_prime[pos] += shift;
+    }
+  }
+
+  free(st->e_delta);
+  st->e_delta = NULL;
+}
+
 int32_t sum(rmMt* st, int32_t idx){
 
   if(idx >= st->n)
@@ -458,22 +638,21 @@ int32_t fwd_search2(rmMt* st, int32_t i) {
 }
 
 // Check a leaf from left to right
-int32_t check_leaf_r(rmMt* st, int32_t i, int32_t d) {
-  int end = (i/st->s+1)*st->s;
+int32_t check_leaf_r(rmMt* st, int32_t i, int32_t target, int32_t excess) {
+  int end = min((i/st->s+1)*st->s, st->n);
   int llimit = (((i)+8)/8)*8;
   int rlimit = (end/8)*8;
-  int32_t excess = d;
   int32_t output;
   int32_t j = 0;
   
   for(j=i+1; j< min(end, llimit); j++){
     excess += 2*bit_array_get_bit(st->bit_array,j)-1;
-    if(excess == d-1)
+    if(excess == target)
       return j;
   }
 
   for(j=llimit; j<rlimit; j+=8) {
-    int32_t desired = d - 1 - excess; // desired value must belongs to the range [-8,8]
+    int32_t desired = target - excess; // desired value must belongs to the range [-8,8]
     
 #ifdef ARCH64
     int32_t sum_idx = (((st->bit_array)->words[j>>logW]) & (0xFFL<<(j&(word_size-1)))) >> (j&(word_size-1));
@@ -493,7 +672,7 @@ int32_t check_leaf_r(rmMt* st, int32_t i, int32_t d) {
   
   for (j=max(llimit,rlimit); j < end; ++j) {
     excess += 2*bit_array_get_bit(st->bit_array,j)-1;
-    if (excess == d-1) {
+    if (excess == target) {
       return j;
     }
   }
@@ -504,7 +683,7 @@ int32_t check_leaf_r(rmMt* st, int32_t i, int32_t d) {
 // Check siblings from left to right
 int32_t check_sibling_r(rmMt* st, int32_t i, int32_t d) {
   int llimit = i;
-  int rlimit = i+st->s;
+  int rlimit = min(i+st->s, st->n);
   int32_t output;
   int32_t excess = st->e_prime[(i-1)/st->s];
   int32_t j = 0;
@@ -523,8 +702,8 @@ int32_t check_sibling_r(rmMt* st, int32_t i, int32_t d) {
       
       int8_t x = T->near_fwd_pos[ii];
       
-      if(x < 8)
-	return j+x;
+      if(x < 8) // The last byte may contain positions beyond the sequence
+	return (j+x < st->n) ? j+x : i-1;
     }
     excess += T->word_sum[sum_idx];
   }
@@ -532,22 +711,58 @@ int32_t check_sibling_r(rmMt* st, int32_t i, int32_t d) {
   return i-1;
 }
 
+// Case 3 of fwd_search: the answer is to the right of the subtree of the node
+// 'node' of the min-max tree, so it is necessary to go up and then down in the
+// tree. It returns i if there is no answer
+static int32_t fwd_search_tree(rmMt* st, int32_t i, int32_t target, long node) {
+  long chunk;
+  // Go up the tree
+  while (!is_root(node)) {
+    if (is_left_child(node)) { // if the node is a left child
+      node = right_sibling(node); // choose right sibling
+
+      if (st->m_prime[node] <= target && target <= st->M_prime[node])
+	break;
+    }
+    node = parent(node); // choose parent
+  }
+
+  // Go down the tree
+  if (!is_root(node)) { // found solution for the query
+    while (!is_leaf(node, st)) {
+      node = left_child(node); // choose left child
+      if (!(st->m_prime[node] <= target && target <= st->M_prime[node])) {
+	node = right_sibling(node); // choose right child == right sibling of the left child
+	if(st->m_prime[node] > target || target > st->M_prime[node]) {
+	  return i;
+	}
+      }
+    }
+
+    chunk = node - st->internal_nodes;
+
+    return check_sibling_r(st, st->s*chunk, target);
+  }
+  return i;
+}
+
 int32_t fwd_search(rmMt* st, int32_t i, int32_t d) {
     // Excess value up to the ith position 
-    int32_t target = sum(st, i) + d - 1;
+    int32_t excess = sum(st, i);
+    int32_t target = excess + d - 1;
     
     int chunk = i / st->s;
     int32_t output;
     long j;
     
     // Case 1: Check if the chunk of i contains fwd_search(bit_array, i, target)
-    output = check_leaf_r(st, i, target);
+    output = check_leaf_r(st, i, target, excess);
     if(output > i)
       return output;
     
     // Case 2: The answer is not in the chunk of i, but it is in its sibling
     // (assuming a binary tree, if i%2==0, then its right sibling is at position i+1)
-    if(chunk%2 == 0) { // The current chunk has a right sibling
+    if(chunk%2 == 0 && chunk+1 < st->num_chunks) { // The current chunk has a right sibling
       // The answer is in the right sibling of the current node
       if(st->m_prime[st->internal_nodes + chunk+1] <= target && target <=
 	 st->M_prime[st->internal_nodes+ chunk+1]) {
@@ -559,41 +774,58 @@ int32_t fwd_search(rmMt* st, int32_t i, int32_t d) {
     }
   
     // Case 3: It is necessary up and then down in the min-max tree
-    long node = parent(chunk + st->internal_nodes); // Initial node
-    // Go up the tree
-    while (!is_root(node)) {
-      if (is_left_child(node)) { // if the node is a left child
-	node = right_sibling(node); // choose right sibling
-	
-	if (st->m_prime[node] <= target && target <= st->M_prime[node])
-	  break;
-      }
-      node = parent(node); // choose parent
-    }
+    return fwd_search_tree(st, i, target, parent(chunk + st->internal_nodes));
+}
 
-    // Go down the tree
-    if (!is_root(node)) { // found solution for the query
-      while (!is_leaf(node, st)) {
-	node = left_child(node); // choose left child
-	if (!(st->m_prime[node] <= target && target <= st->M_prime[node])) {
-	  node = right_sibling(node); // choose right child == right sibling of the left child
-	  if(st->m_prime[node] > target || target > st->M_prime[node]) {
-	    return i;
-	  }
-	}
-      }
-      
-      chunk = node - st->internal_nodes;
+// fwd_search that scans linearly the leaves of the min-max tree of the next
+// st->scan_chunks chunks before going up in the tree. Since the excess changes
+// by +/-1, the first leaf whose range [m',M'] contains target has the answer.
+// excess is the excess value at position i
+static int32_t fwd_search_adaptive(rmMt* st, int32_t i, int32_t excess, int32_t d) {
+  int32_t target = excess + d - 1;
+
+  long chunk = i / st->s;
+  long last = min(chunk + st->scan_chunks, (long)st->num_chunks - 1);
+  int32_t output;
+
+  // Check the chunk of i
+  output = check_leaf_r(st, i, target, excess);
+  if(output > i)
+    return output;
+
+  // Scan the next leaves
+  for(long c = chunk+1; c <= last; c++) {
+    long node = st->internal_nodes + c;
 
-      return check_sibling_r(st, st->s*chunk, target);
+    if(st->m_prime[node] <= target && target <= st->M_prime[node]) {
+      output = check_sibling_r(st, st->s*c, target);
+      return (output >= st->s*c) ? output : i;
     }
+  }
+
+  if(last == st->num_chunks - 1)
     return i;
+
+  // Go up and down in the min-max tree from the last scanned leaf
+  return fwd_search_tree(st, i, target, st->internal_nodes + last);
 }
 
 int32_t find_close(rmMt* st, int32_t i){
   if(bit_array_get_bit(st->bit_array,i) == 0)
     return i;
 
+#ifdef PIONEER
+  if(st->pioneers)
+    return pioneer_find_close(st, i);
+#endif
+
+  return fwd_search_adaptive(st, i, sum(st, i), 0);
+}
+
+int32_t find_close_tree(rmMt* st, int32_t i){
+  if(bit_array_get_bit(st->bit_array,i) == 0)
+    return i;
+
   return fwd_search(st, i, 0);
 }
 
@@ -815,34 +1047,12 @@ int32_t check_sibling_l(rmMt* st, int32_t i, int32_t excess, int32_t d) {
   return i-1;
 }
 
-int32_t bwd_search(rmMt* st, int32_t i, int32_t d) {
-  int32_t excess = sum(st, i);
-  int32_t target = excess + d;
-
-  int chunk = i / st->s;
-  int32_t output = i;
-  long j;
-
-  // Case 1: Check if the chunk of i contains bwd_search(bit_array, i, target)
-  output = check_leaf_l(st, i, target, excess);
-  if(output < i)
-    return output;
-  
-  // Case 2: The answer is not in the chunk of i, but it is in its sibling
-  // (assuming a binary tree, if i%2==1, then its left sibling is at position i-1)
-  if(chunk%2 == 1) { // The current chunk has a left sibling
-    // The answer is in the left sibling of the current node
-    if(st->m_prime[st->internal_nodes + chunk - 1] <= excess-d+1 && excess-d+1 <=
-       st->M_prime[st->internal_nodes + chunk - 1]) {
-      
-      output = check_sibling_l(st, st->s*(chunk-1), excess, d);
-      if(output >= st->s*(chunk-1))
-  	return output;
-    }
-  }
-
-  // Case 3: It is necessary up and then down in the min-max tree
-  long node = parent(chunk + st->internal_nodes); // Initial node
+// Case 3 of bwd_search: the answer is to the left of the subtree of the node
+// 'node' of the min-max tree, so it is necessary to go up and then down in the
+// tree. It returns i if there is no answer
+static int32_t bwd_search_tree(rmMt* st, int32_t i, int32_t excess, int32_t d,
+			       long node) {
+  long chunk;
   // Go up the tree
   while (!is_root(node)) {
     if (is_right_child(node)) { // if the node is a left child
@@ -882,13 +1092,89 @@ int32_t bwd_search(rmMt* st, int32_t i, int32_t d) {
     
     return check_sibling_l(st, st->s*chunk, excess, d);
   }
-  else {// Special case: Pair of parentheses wrapping the parentheses sequence
-        //(at positions 0 and n-1)
-    if(i == st->n-1 && excess==0)
-      output = 0;
+  else {// Special case: the answer is the first position, whose previous
+        // excess value (position -1) is 0 and is not stored in the min-max
+        // tree. E.g., the parent of a child of the root, or the pair of
+        // parentheses wrapping the parentheses sequence (at positions 0 and n-1)
+    if(excess-d == 0)
+      return 0;
   }
 
-  return output;
+  return i;
+}
+
+
+int32_t bwd_search(rmMt* st, int32_t i, int32_t d) {
+  int32_t excess = sum(st, i);
+  int32_t target = excess + d;
+
+  int chunk = i / st->s;
+  int32_t output = i;
+  long j;
+
+  // The answer is i itself (check_leaf_l returns i when it fails)
+  if(d == 2*bit_array_get_bit(st->bit_array,i)-1)
+    return i;
+
+  // Case 1: Check if the chunk of i contains bwd_search(bit_array, i, target)
+  output = check_leaf_l(st, i, target, excess);
+  if(output < i)
+    return output;
+  
+  // Case 2: The answer is not in the chunk of i, but it is in its sibling
+  // (assuming a binary tree, if i%2==1, then its left sibling is at position i-1)
+  if(chunk%2 == 1) { // The current chunk has a left sibling
+    // The answer is in the left sibling of the current node
+    if(st->m_prime[st->internal_nodes + chunk - 1] <= excess-d && excess-d <=
+       st->M_prime[st->internal_nodes + chunk - 1]) {
+      
+      output = check_sibling_l(st, st->s*(chunk-1), excess, d);
+      if(output >= st->s*(chunk-1))
+  	return output;
+    }
+  }
+
+  // Case 3: It is necessary up and then down in the min-max tree
+  return bwd_search_tree(st, i, excess, d, parent(chunk + st->internal_nodes));
+}
+
+// bwd_search that scans linearly the leaves of the min-max tree of the
+// previous st->scan_chunks chunks before going up in the tree (see
+// fwd_search_adaptive)
+static int32_t bwd_search_adaptive(rmMt* st, int32_t i, int32_t excess, int32_t d) {
+  long chunk = i / st->s;
+  long first = max(chunk - (long)st->scan_chunks, 0L);
+  int32_t output;
+
+  // The answer is i itself (check_leaf_l returns i when it fails)
+  if(d == 2*bit_array_get_bit(st->bit_array,i)-1)
+    return i;
+
+  // Check the chunk of i
+  output = check_leaf_l(st, i, excess + d, excess);
+  if(output < i)
+    return output;
+
+  // Scan the previous leaves
+  for(long c = chunk-1; c >= first; c--) {
+    long node = st->internal_nodes + c;
+
+    // The answer is the first position of the chunk c+1
+    if(st->e_prime[c] == excess-d)
+      return (c+1)*st->s;
+
+    if(st->m_prime[node] <= excess-d && excess-d <= st->M_prime[node]) {
+      output = check_sibling_l(st, st->s*c, excess, d);
+      return (output >= st->s*c) ? output : i;
+    }
+  }
+
+  // The excess value at position -1 is 0 (see bwd_search)
+  if(first == 0)
+    return (excess-d == 0) ? 0 : i;
+
+  // Go up and down in the min-max tree from the last scanned leaf
+  return bwd_search_tree(st, i, excess, d, st->internal_nodes + first);
 }
 
 int32_t find_open_naive(rmMt* st, int32_t i){
@@ -902,7 +1188,19 @@ int32_t find_open(rmMt* st, int32_t i){
   if(bit_array_get_bit(st->bit_array,i) == 1)
     return i;
 
-  return bwd_search(st, i, 0);  
+#ifdef PIONEER
+  if(st->pioneers)
+    return pioneer_find_open(st, i);
+#endif
+
+  return bwd_search_adaptive(st, i, sum(st, i), 0);
+}
+
+int32_t find_open_tree(rmMt* st, int32_t i){
+  if(bit_array_get_bit(st->bit_array,i) == 1)
+    return i;
+
+  return bwd_search(st, i, 0);
 }
 
 int32_t find_open_semi(rmMt* st, int32_t i){
@@ -912,6 +1210,88 @@ int32_t find_open_semi(rmMt* st, int32_t i){
   return semi_bwd_search(st, i, 0);  
 }
 
+// Number of queries, of rounds and of scanned leaves per query of st_calibrate
+#define CALIBRATE_QUERIES 4096
+#define CALIBRATE_ROUNDS 5
+#define CALIBRATE_SCAN 64
+
+static double elapsed(struct timespec* stime) {
+  struct timespec etime;
+
+  clock_gettime(CLOCK_MONOTONIC, &etime);
+  return (etime.tv_sec - stime->tv_sec) + (etime.tv_nsec - stime->tv_nsec) / 1000000000.0;
+}
+
+unsigned int st_calibrate(rmMt* st) {
+  int32_t* I = (int32_t*)malloc(CALIBRATE_QUERIES*sizeof(int32_t));
+  int32_t* target = (int32_t*)malloc(CALIBRATE_QUERIES*sizeof(int32_t));
+  unsigned int seed = 1;
+  long q = 0;
+
+  // Sample of find_close queries whose answer is not in the chunk of i
+  for(long t = 0; t < 64*CALIBRATE_QUERIES && q < CALIBRATE_QUERIES; t++) {
+    int32_t i = ((unsigned long)rand_r(&seed) * (RAND_MAX + 1UL) +
+		 rand_r(&seed)) % st->n;
+    if(bit_array_get_bit(st->bit_array,i) == 0)
+      continue;
+
+    int32_t excess = sum(st, i);
+    if(check_leaf_r(st, i, excess-1, excess) > i)
+      continue;
+
+    I[q] = i;
+    target[q++] = excess-1;
+  }
+
+  if(q > 0) {
+    struct timespec stime;
+    volatile int32_t sink = 0;
+
+    // Average time of a search that goes up and down the min-max tree and
+    // average time to check a leaf of the min-max tree, scanning
+    // CALIBRATE_SCAN leaves from the chunk of each query. The excess value -1
+    // is never reached, so all of them are checked. The best of several rounds
+    // is kept
+    double tree = 0, leaf = 0;
+    int32_t missing = -1;
+    for(int round = 0; round < CALIBRATE_ROUNDS; round++) {
+      clock_gettime(CLOCK_MONOTONIC, &stime);
+      for(long k = 0; k < q; k++)
+	sink += fwd_search_tree(st, I[k], target[k],
+				st->internal_nodes + I[k] / st->s);
+      double t = elapsed(&stime) / q;
+      if(round == 0 || t < tree)
+	tree = t;
+
+      long scanned = 0;
+      clock_gettime(CLOCK_MONOTONIC, &stime);
+      for(long k = 0; k < q; k++) {
+	long c, first = I[k] / st->s;
+	long last = min(first + CALIBRATE_SCAN, (long)st->num_chunks);
+	for(c = first; c < last; c++) {
+	  long node = st->internal_nodes + c;
+	  if(st->m_prime[node] <= missing && missing <= st->M_prime[node])
+	    break;
+	}
+	scanned += c - first;
+      }
+      t = elapsed(&stime) / scanned;
+      if(round == 0 || t < leaf)
+	leaf = t;
+    }
+
+    if(leaf > 0)
+      st->scan_chunks = min(tree / leaf, MAX_SCAN_CHUNKS);
+    else
+      st->scan_chunks = MAX_SCAN_CHUNKS;
+  }
+
+  free(I);
+  free(target);
+
+  return st->scan_chunks;
+}
+
 int32_t rank_1(rmMt* st, int32_t i) {
     // Excess value up to the ith position 
   if(i >= st->n)
@@ -951,50 +1331,92 @@ int32_t check_chunk(rmMt* st, int32_t i, int32_t d) {
   return i-1;
 }
 
-// ToDo: Implement it more efficiently
-int32_t select_0(rmMt* st, int32_t i){
-
-  int32_t j = 0;
+// Number of bits equal to 'bit' in the chunks [0,chunk]
+static inline int32_t chunk_rank(rmMt* st, long chunk, int bit) {
+  int32_t ones = (st->s*(chunk+1) + st->e_prime[chunk])/2;
 
-  // The answer is after the position 2*i-1
-  int32_t excess = sum(st,2*i-1);
+  return bit ? ones : st->s*(chunk+1) - ones;
+}
 
-  // Note: The answer is not beyond the position 2*i-1+depth_max, where
-  // depth_max is the maximal depth (excess) of the input tree
-  int32_t llimit = 2*i-1;
-  int32_t rlimit = llimit + st->M_prime[0];
-  int32_t d = 0;
+// Position of the ith bit equal to 'bit' (i >= 1), or -1 if it does not exist.
+// A binary search over the excess values at the end of the chunks (e') finds
+// the chunk of the answer, which is then scanned byte by byte
+static int32_t select_bit(rmMt* st, int32_t i, int bit) {
+  if(i <= 0)
+    return -1;
 
-  for (j=llimit+1; j <=rlimit; ++j,++d) {
-    if (excess == d)
-      return j-1;
-    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+  // The last chunk may be incomplete, so it is never used in the search
+  long lo = 0, hi = st->num_chunks-1;
+  while(lo < hi) {
+    long mid = (lo+hi)/2;
+    if(chunk_rank(st, mid, bit) >= i)
+      hi = mid;
+    else
+      lo = mid+1;
   }
 
-    return -1;
-}
-
-// ToDo: Implement it more efficiently
-int32_t select_1(rmMt* st, int32_t i){
-  int32_t j = 0;
+  int32_t rank = lo ? chunk_rank(st, lo-1, bit) : 0;
+  int32_t end = min((lo+1)*st->s, st->n);
+  int32_t j;
 
-  // Note: The answer is in the range [0,2*i-1] not beyond the position 2*i-1
-  int32_t excess = 0;
-  int32_t llimit = 0;
-  int32_t rlimit = 2*i-1;
-  int32_t d = 2*i-1;
+  for(j = lo*st->s; j+8 <= end; j += 8) {
+    int32_t ones = (8 + T->word_sum[get_byte(st, j)])/2;
+    int32_t count = bit ? ones : 8-ones;
+    if(rank + count >= i)
+      break;
+    rank += count;
+  }
 
-  for (j=llimit; j <=rlimit; ++j,--d) {
-    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
-    if (excess == d)
+  for(; j < end; j++)
+    if(bit_array_get_bit(st->bit_array,j) == bit && ++rank == i)
       return j;
-  }
 
-    return -1;
+  return -1;
 }
 
+int32_t select_0(rmMt* st, int32_t i){
+  return select_bit(st, i, 0);
+}
 
-int32_t match(rmMt* st, int32_t i) {
+int32_t select_1(rmMt* st, int32_t i){
+  return select_bit(st, i, 1);
+}
+
+int32_t next_0(rmMt* st, int32_t i) {
+  long end = min(((long)(i+1)/st->s + 1)*st->s, (long)st->n);
+
+  for(long j = i+1; j < end; j = ((j >> logW) + 1) << logW) {
+    word_t w = ~st->bit_array->words[j >> logW] >> (j & (word_size-1));
+    if(w) {
+      long zero = j + ctz_word(w);
+      if(zero < end)
+	return zero;
+      break;
+    }
+  }
+
+  return select_0(st, (i >= 0) ? rank_0(st, i)+1 : 1);
+}
+
+int32_t prev_0(rmMt* st, int32_t i) {
+  long begin = ((long)(i-1)/st->s)*st->s;
+
+  for(long j = i-1; j >= begin && j >= 0; j = ((j >> logW) << logW) - 1) {
+    long shift = word_size - 1 - (j & (word_size-1));
+    word_t w = (~st->bit_array->words[j >> logW] << shift) >> shift;
+    if(w) {
+      long zero = ((j >> logW) << logW) + word_size - 1 - clz_word(w);
+      if(zero >= begin)
+	return zero;
+      break;
+    }
+  }
+
+  return (i > 0) ? select_0(st, rank_0(st, i-1)) : -1;
+}
+
+
+int32_t match(rmMt* st, int32_t i) {
   if(bit_array_get_bit(st->bit_array,i))
     return find_close(st, i);
   else
@@ -1017,6 +1439,11 @@ int32_t match_semi(rmMt* st, int32_t i) {
 
 
 int32_t parent_t(rmMt* st, int32_t i) {
+#ifdef PIONEER
+  if(st->pioneers)
+    return pioneer_enclose(st, i);
+#endif
+
   if(!bit_array_get_bit(st->bit_array,i))
     i = find_open(st, i);
   
@@ -1047,9 +1474,9 @@ int32_t next_sibling(rmMt* st, int32_t i) {
   if(!bit_array_get_bit(st->bit_array,i))
     return -1;
 
-  i = find_close(st, i);  
-  
-  if(bit_array_get_bit(st->bit_array,i+1))
+  i = find_close(st, i);
+
+  if(i < st->n-1 && bit_array_get_bit(st->bit_array,i+1))
     return i+1;
   else 
     return -1;
@@ -1068,11 +1495,837 @@ int32_t is_leaf_t(rmMt* st, int32_t i) {
   return 0;
 }
 
+/*
+ * Finger searches. A finger caches the excess value at a position, so the
+ * searches that start at (or near) the previous answer do not compute sum.
+ * The path from the leaf of the finger to the root of the min-max tree is
+ * implicit in the heap layout, so the searches go up only as far as the
+ * distance to the answer requires.
+ */
+
+// Excess value of the positions (a,b]
+static int32_t excess_range(rmMt* st, int32_t a, int32_t b) {
+  int32_t excess = 0;
+  int32_t j = a+1;
+
+  for(; j <= b && (j&7); j++)
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+  for(; j+7 <= b; j += 8)
+    excess += T->word_sum[get_byte(st, j)];
+  for(; j <= b; j++)
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+
+  return excess;
+}
+
+void finger_init(rmMt* st, finger_t* f, int32_t i) {
+  f->pos = i;
+  f->excess = sum(st, i);
+}
+
+void finger_move(rmMt* st, finger_t* f, int32_t i) {
+  if(i >= f->pos && i - f->pos <= st->s)
+    f->excess += excess_range(st, f->pos, i);
+  else if(i < f->pos && f->pos - i <= st->s)
+    f->excess -= excess_range(st, i, f->pos);
+  else
+    f->excess = sum(st, i);
+
+  f->pos = i;
+}
+
+int32_t finger_fwd_search(rmMt* st, finger_t* f, int32_t d) {
+  int32_t j = fwd_search_adaptive(st, f->pos, f->excess, d);
+
+  if(j != f->pos) {
+    f->pos = j;
+    f->excess += d - 1;
+  }
+
+  return j;
+}
+
+int32_t finger_bwd_search(rmMt* st, finger_t* f, int32_t d) {
+  int32_t j = bwd_search_adaptive(st, f->pos, f->excess, d);
+
+  if(j != f->pos) {
+    // The excess value at j-1 is the excess value at the finger minus d
+    f->pos = j;
+    f->excess += 2*bit_array_get_bit(st->bit_array,j)-1 - d;
+  }
+
+  return j;
+}
+
+int32_t finger_find_close(rmMt* st, finger_t* f) {
+  if(bit_array_get_bit(st->bit_array,f->pos) == 0)
+    return f->pos;
+
+#ifdef PIONEER
+  if(st->pioneers) {
+    f->pos = pioneer_find_close(st, f->pos);
+    f->excess--;
+    return f->pos;
+  }
+#endif
+
+  return finger_fwd_search(st, f, 0);
+}
+
+int32_t finger_find_open(rmMt* st, finger_t* f) {
+  if(bit_array_get_bit(st->bit_array,f->pos) == 1)
+    return f->pos;
+
+#ifdef PIONEER
+  if(st->pioneers) {
+    f->pos = pioneer_find_open(st, f->pos);
+    f->excess++;
+    return f->pos;
+  }
+#endif
+
+  return finger_bwd_search(st, f, 0);
+}
+
+int32_t finger_first_child(rmMt* st, finger_t* f) {
+  if(f->pos >= st->n-1 || !bit_array_get_bit(st->bit_array,f->pos) ||
+     !bit_array_get_bit(st->bit_array,f->pos+1))
+    return -1;
+
+  f->pos++;
+  f->excess++;
+
+  return f->pos;
+}
+
+int32_t finger_next_sibling(rmMt* st, finger_t* f) {
+  if(f->pos >= st->n-1 || !bit_array_get_bit(st->bit_array,f->pos))
+    return -1;
+
+  int32_t i = finger_find_close(st, f);
+
+  if(i >= st->n-1 || !bit_array_get_bit(st->bit_array,i+1))
+    return -1;
+
+  f->pos = i+1;
+  f->excess++;
+
+  return f->pos;
+}
+
 ulong size_rmMt(rmMt *st) {
   ulong sizeRmMt = sizeof(rmMt);
   ulong sizeBitArray = st->bit_array->num_of_bits/8;
-  ulong sizePrimes = 3*((st->num_chunks + st->internal_nodes)*sizeof(int16_t)) +
-    st->num_chunks*sizeof(int16_t);
+  ulong sizePrimes = 2*((st->num_chunks + st->internal_nodes)*sizeof(depth_t)) +
+    (st->num_chunks + st->internal_nodes)*sizeof(int32_t) +
+    st->num_chunks*sizeof(depth_t);
+  if(st->l_prime)
+    sizePrimes += st->num_chunks*sizeof(int32_t);
+  if(st->e_delta)
+    sizePrimes += (st->num_chunks+1)*sizeof(depth_t);
+  sizePrimes += size_pioneers(st);
 
   return sizeRmMt + sizeBitArray + sizePrimes;
 }
+
+void st_free(rmMt* st) {
+  st_free_pioneers(st);
+  free(st->e_prime);
+  free(st->m_prime);
+  free(st->M_prime);
+  free(st->n_prime);
+  free(st->l_prime);
+  free(st->e_delta);
+  bit_array_free(st->bit_array);
+  free(st);
+}
+
+/*
+ * Range minimum queries over the excess values
+ */
+
+// It computes the minimum excess value in the range [from,to] and its number
+// of occurrences, where 'excess' is the excess value up to position from-1
+static void scan_min(rmMt* st, int32_t from, int32_t to, int32_t excess,
+		     int32_t* min, int32_t* count) {
+  int32_t m = INT32_MAX, c = 0, j = from;
+
+  for(; j <= to && (j & 7); j++) {
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+    if(excess < m) {
+      m = excess;
+      c = 1;
+    }
+    else if(excess == m)
+      c++;
+  }
+
+  for(; j+7 <= to; j+=8) {
+    int32_t w = get_byte(st, j);
+    int32_t wm = excess + T->min[w];
+    if(wm < m) {
+      m = wm;
+      c = T->min_count[w];
+    }
+    else if(wm == m)
+      c += T->min_count[w];
+    excess += T->word_sum[w];
+  }
+
+  for(; j <= to; j++) {
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+    if(excess < m) {
+      m = excess;
+      c = 1;
+    }
+    else if(excess == m)
+      c++;
+  }
+
+  *min = m;
+  *count = c;
+}
+
+// It returns the position of the t-th occurrence of the excess value m in the
+// range [from,to], where 'excess' is the excess value up to position from-1.
+// If there are less than t occurrences, it returns -1 and t is decreased by
+// the number of occurrences in the range
+static int32_t scan_select(rmMt* st, int32_t from, int32_t to, int32_t excess,
+			   int32_t m, int32_t* t) {
+  int32_t j = from;
+
+  for(; j <= to && (j & 7); j++) {
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+    if(excess == m && --(*t) == 0)
+      return j;
+  }
+
+  for(; j+7 <= to; j+=8) {
+    int32_t w = get_byte(st, j);
+    if(excess + T->min[w] == m) { // m is the minimum of the word
+      if(*t > T->min_count[w])
+	*t -= T->min_count[w];
+      else
+	break;
+    }
+    excess += T->word_sum[w];
+  }
+
+  for(; j <= to; j++) {
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+    if(excess == m && --(*t) == 0)
+      return j;
+  }
+
+  return -1;
+}
+
+// It stores in 'nodes' the nodes of the min-max tree that exactly cover the
+// chunks [a,b], from left to right. It returns the number of nodes
+static int cover_chunks(rmMt* st, long a, long b, long* nodes) {
+  long left[64], right[64];
+  int nl = 0, nr = 0;
+  long l = st->internal_nodes + a, r = st->internal_nodes + b;
+
+  while(l <= r) {
+    if(l == r) {
+      left[nl++] = l;
+      break;
+    }
+    if(is_right_child(l))
+      left[nl++] = l++;
+    if(is_left_child(r))
+      right[nr++] = r--;
+    if(l > r)
+      break;
+    l = parent(l);
+    r = parent(r);
+  }
+
+  for(int k = 0; k < nl; k++)
+    nodes[k] = left[k];
+  for(int k = 0; k < nr; k++)
+    nodes[nl+k] = right[nr-1-k];
+
+  return nl + nr;
+}
+
+/*
+ * Minimum excess value in [i,j] (m), its number of occurrences (count) and,
+ * if t > 0, the position of its t-th occurrence (pos, -1 if it does not
+ * exist). The range is divided into the partial chunk of i, the nodes of the
+ * min-max tree that cover the complete chunks and the partial chunk of j.
+ */
+static void range_min(rmMt* st, int32_t i, int32_t j, int32_t t,
+		      int32_t* m, int32_t* count, int32_t* pos) {
+  long ci = i/st->s, cj = j/st->s;
+  int32_t excess_i = (i > 0) ? sum(st, i-1) : 0;
+  int32_t min, c, cm, cc;
+  long nodes[128];
+  int num_nodes = 0;
+
+  *pos = -1;
+
+  if(ci == cj) {
+    scan_min(st, i, j, excess_i, &min, &c);
+    *m = min;
+    *count = c;
+    if(t > 0 && t <= c)
+      *pos = scan_select(st, i, j, excess_i, min, &t);
+    return;
+  }
+
+  int32_t i_end = (ci+1)*st->s-1, j_begin = cj*st->s;
+
+  scan_min(st, i, i_end, excess_i, &min, &c);
+
+  if(ci+1 <= cj-1)
+    num_nodes = cover_chunks(st, ci+1, cj-1, nodes);
+  for(int k = 0; k < num_nodes; k++) {
+    if(st->m_prime[nodes[k]] < min) {
+      min = st->m_prime[nodes[k]];
+      c = st->n_prime[nodes[k]];
+    }
+    else if(st->m_prime[nodes[k]] == min)
+      c += st->n_prime[nodes[k]];
+  }
+
+  scan_min(st, j_begin, j, st->e_prime[cj-1], &cm, &cc);
+  if(cm < min) {
+    min = cm;
+    c = cc;
+  }
+  else if(cm == min)
+    c += cc;
+
+  *m = min;
+  *count = c;
+
+  if(t <= 0 || t > c)
+    return;
+
+  // Partial chunk of i
+  if((*pos = scan_select(st, i, i_end, excess_i, min, &t)) >= 0)
+    return;
+
+  // Complete chunks
+  for(int k = 0; k < num_nodes; k++) {
+    long node = nodes[k];
+    if(st->m_prime[node] != min)
+      continue;
+    if(t > st->n_prime[node]) {
+      t -= st->n_prime[node];
+      continue;
+    }
+
+    while(!is_leaf(node, st)) {
+      node = left_child(node);
+      if(st->m_prime[node] == min) {
+	if(t <= st->n_prime[node])
+	  continue;
+	t -= st->n_prime[node];
+      }
+      node = right_sibling(node);
+    }
+
+    long chunk = node - st->internal_nodes;
+    *pos = scan_select(st, chunk*st->s, (chunk+1)*st->s-1,
+		       st->e_prime[chunk-1], min, &t);
+    return;
+  }
+
+  // Partial chunk of j
+  *pos = scan_select(st, j_begin, j, st->e_prime[cj-1], min, &t);
+}
+
+int32_t min_excess(rmMt* st, int32_t i, int32_t j) {
+  int32_t m, count, pos;
+
+  range_min(st, i, j, 0, &m, &count, &pos);
+  return m;
+}
+
+int32_t rmq(rmMt* st, int32_t i, int32_t j) {
+  int32_t m, count, pos;
+
+  range_min(st, i, j, 1, &m, &count, &pos);
+  return pos;
+}
+
+int32_t rmq_count(rmMt* st, int32_t i, int32_t j) {
+  int32_t m, count, pos;
+
+  range_min(st, i, j, 0, &m, &count, &pos);
+  return count;
+}
+
+int32_t rmq_select(rmMt* st, int32_t i, int32_t j, int32_t t) {
+  int32_t m, count, pos;
+
+  range_min(st, i, j, t, &m, &count, &pos);
+  return pos;
+}
+
+/*
+ * Range maximum queries over the excess values
+ */
+
+// It computes the maximum excess value in the range [from,to] and the
+// leftmost position where it is reached, where 'excess' is the excess value
+// up to position from-1
+static void scan_max(rmMt* st, int32_t from, int32_t to, int32_t excess,
+		     int32_t* max, int32_t* pos) {
+  int32_t M = INT32_MIN, p = -1, j = from;
+
+  for(; j <= to && (j & 7); j++) {
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+    if(excess > M) {
+      M = excess;
+      p = j;
+    }
+  }
+
+  for(; j+7 <= to; j+=8) {
+    int32_t w = get_byte(st, j);
+    if(excess + T->max[w] > M) {
+      M = excess + T->max[w];
+      p = j + T->max_pos_min[w];
+    }
+    excess += T->word_sum[w];
+  }
+
+  for(; j <= to; j++) {
+    excess += 2*bit_array_get_bit(st->bit_array,j)-1;
+    if(excess > M) {
+      M = excess;
+      p = j;
+    }
+  }
+
+  *max = M;
+  *pos = p;
+}
+
+/*
+ * Maximum excess value in [i,j] (M) and the leftmost position where it is
+ * reached (pos). It follows the same decomposition of the range as range_min.
+ */
+static void range_max(rmMt* st, int32_t i, int32_t j, int32_t* M,
+		      int32_t* pos) {
+  long ci = i/st->s, cj = j/st->s;
+  int32_t excess_i = (i > 0) ? sum(st, i-1) : 0;
+  int32_t max, p, cM, cp;
+  long nodes[128], best = -1;
+  int num_nodes = 0;
+
+  if(ci == cj) {
+    scan_max(st, i, j, excess_i, M, pos);
+    return;
+  }
+
+  scan_max(st, i, (ci+1)*st->s-1, excess_i, &max, &p);
+
+  if(ci+1 <= cj-1)
+    num_nodes = cover_chunks(st, ci+1, cj-1, nodes);
+  for(int k = 0; k < num_nodes; k++)
+    if(st->M_prime[nodes[k]] > max) {
+      max = st->M_prime[nodes[k]];
+      best = nodes[k];
+    }
+
+  scan_max(st, cj*st->s, j, st->e_prime[cj-1], &cM, &cp);
+  if(cM > max) {
+    *M = cM;
+    *pos = cp;
+    return;
+  }
+
+  *M = max;
+  if(best < 0) { // The maximum is in the partial chunk of i
+    *pos = p;
+    return;
+  }
+
+  // Leftmost leaf of the node 'best' that reaches the maximum
+  while(!is_leaf(best, st)) {
+    best = left_child(best);
+    if(st->M_prime[best] != max)
+      best = right_sibling(best);
+  }
+
+  long chunk = best - st->internal_nodes;
+  scan_max(st, chunk*st->s, (chunk+1)*st->s-1, st->e_prime[chunk-1], &max, pos);
+}
+
+int32_t max_excess(rmMt* st, int32_t i, int32_t j) {
+  int32_t M, pos;
+
+  range_max(st, i, j, &M, &pos);
+  return M;
+}
+
+int32_t rmq_max(rmMt* st, int32_t i, int32_t j) {
+  int32_t M, pos;
+
+  range_max(st, i, j, &M, &pos);
+  return pos;
+}
+
+/*
+ * Height
+ */
+
+// The root has depth 1, so the height is the maximum excess value minus 1
+int32_t height_t(rmMt* st) {
+  return st->M_prime[0]-1;
+}
+
+int32_t subtree_height(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  return max_excess(st, i, find_close(st, i)) - depth(st, i);
+}
+
+int32_t deepest_node(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  return rmq_max(st, i, find_close(st, i));
+}
+
+/*
+ * Lowest common ancestor
+ */
+
+int32_t lca(rmMt* st, int32_t i, int32_t j) {
+  int32_t m, count, pos;
+
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+  if(!bit_array_get_bit(st->bit_array,j))
+    j = find_open(st, j);
+
+  if(i > j) {
+    int32_t tmp = i;
+    i = j;
+    j = tmp;
+  }
+
+  // If i is an ancestor of j, the excess value of i is the leftmost minimum
+  // of [i,j]. Otherwise, the leftmost minimum is the closing parenthesis of a
+  // child of the lca, followed by the opening parenthesis of its next child
+  range_min(st, i, j, 1, &m, &count, &pos);
+  if(pos == i)
+    return i;
+
+  return parent_t(st, pos+1);
+}
+
+int32_t distance(rmMt* st, int32_t i, int32_t j) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+  if(!bit_array_get_bit(st->bit_array,j))
+    j = find_open(st, j);
+
+  return depth(st, i) + depth(st, j) - 2*depth(st, lca(st, i, j));
+}
+
+/*
+ * Level-wise navigation
+ */
+
+int32_t level_ancestor(rmMt* st, int32_t i, int32_t k) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  if(k <= 0)
+    return (k == 0) ? i : -1;
+
+  int32_t output = bwd_search(st, i, k+1);
+  if(output == i) // There are less than k ancestors
+    return -1;
+
+  return output;
+}
+
+int32_t level_next(rmMt* st, int32_t i) {
+  if(bit_array_get_bit(st->bit_array,i))
+    i = find_close(st, i);
+
+  if(i >= st->n-1)
+    return -1;
+
+  int32_t output = fwd_search(st, i, 2);
+  if(output == i)
+    return -1;
+
+  return output;
+}
+
+int32_t level_prev(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  if(i == 0)
+    return -1;
+
+  // The closing parenthesis of the previous node of the level is the position
+  // following the last excess value equal to the excess value of i
+  int32_t output = bwd_search(st, i-1, -1);
+  if(bit_array_get_bit(st->bit_array,output)) // Not found
+    return -1;
+
+  return find_open(st, output);
+}
+
+int32_t level_leftmost(rmMt* st, int32_t d) {
+  if(d < 1)
+    return -1;
+  if(d == 1)
+    return 0;
+
+  int32_t output = fwd_search(st, 0, d);
+  if(output == 0)
+    return -1;
+
+  return output;
+}
+
+int32_t level_rightmost(rmMt* st, int32_t d) {
+  if(d < 1)
+    return -1;
+  if(d == 1)
+    return 0;
+
+  int32_t output = bwd_search(st, st->n-1, -d);
+  if(output == st->n-1)
+    return -1;
+
+  return find_open(st, output);
+}
+
+/*
+ * Subtree size, preorder and postorder
+ */
+
+int32_t subtree_size(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  return (find_close(st, i)-i+1)/2;
+}
+
+int32_t preorder_rank(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  return rank_1(st, i);
+}
+
+int32_t preorder_select(rmMt* st, int32_t t) {
+  return select_1(st, t);
+}
+
+int32_t postorder_rank(rmMt* st, int32_t i) {
+  if(bit_array_get_bit(st->bit_array,i))
+    i = find_close(st, i);
+
+  return rank_0(st, i);
+}
+
+int32_t postorder_select(rmMt* st, int32_t t) {
+  int32_t i = select_0(st, t);
+  if(i < 0)
+    return -1;
+
+  return find_open(st, i);
+}
+
+int32_t is_ancestor(rmMt* st, int32_t i, int32_t j) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  return i <= j && j <= find_close(st, i);
+}
+
+/*
+ * Children of a node
+ */
+
+// The closing parentheses of the children of i are the minima of the excess
+// values in the range [i+1,find_close(i)-1]
+
+int32_t degree(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  int32_t close = find_close(st, i);
+  if(close == i+1) // Leaf
+    return 0;
+
+  return rmq_count(st, i+1, close-1);
+}
+
+int32_t child(rmMt* st, int32_t i, int32_t t) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  if(t < 1 || i >= st->n-1 || !bit_array_get_bit(st->bit_array,i+1))
+    return -1;
+  if(t == 1)
+    return i+1;
+
+  // Closing parenthesis of the (t-1)th child
+  int32_t close = find_close(st, i);
+  int32_t output = rmq_select(st, i+1, close-1, t-1);
+  if(output < 0 || output+1 == close)
+    return -1;
+
+  return output+1;
+}
+
+int32_t child_rank(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  if(i == 0) // Root
+    return 1;
+
+  int32_t p = parent_t(st, i);
+  if(p+1 == i) // First child
+    return 1;
+
+  return rmq_count(st, p+1, i-1)+1;
+}
+
+/*
+ * Leaves
+ */
+
+// Leaves ("10" patterns) of the kth word of the bit array. The pth bit of the
+// result is set if there is a leaf at position k*word_size+p
+static inline word_t leaf_word(rmMt* st, long k) {
+  word_t* words = (st->bit_array)->words;
+  word_t w = words[k];
+  word_t next = (k+1 < ((st->n+word_size-1) >> logW)) ? words[k+1] : 0;
+
+  return w & ~((w >> 1) | (next << (word_size-1)));
+}
+
+// Number of leaves whose opening parenthesis is in the range [from,to]
+static int32_t count_leaves(rmMt* st, int32_t from, int32_t to) {
+  int32_t count = 0;
+
+  for(long k = from >> logW; k <= (to >> logW); k++) {
+    word_t w = leaf_word(st, k);
+
+    if(k == (from >> logW))
+      w &= ~(word_t)0 << (from & (word_size-1));
+    if(k == (to >> logW) && (to & (word_size-1)) < word_size-1)
+      w &= ((word_t)1 << ((to & (word_size-1))+1)) - 1;
+    count += __builtin_popcountl(w);
+  }
+
+  return count;
+}
+
+void st_create_leaves(rmMt* st) {
+  st->l_prime = (int32_t*)calloc(st->num_chunks, sizeof(int32_t));
+
+  unsigned int num_threads;
+  if(st->num_chunks < threads)
+    num_threads = st->num_chunks;
+  else
+    num_threads = threads;
+
+  // Each thread works on 'chunks_per_thread' consecutive chunks of the bit_array
+  unsigned int chunks_per_thread = ceil((double)st->num_chunks/num_threads);
+
+  // Each thread computes the prefix computation of its chunks
+  cilk_for(unsigned int thread = 0; thread < num_threads; thread++) {
+    int32_t partial_leaves = 0;
+
+    for(long chunk = thread*chunks_per_thread;
+	chunk < min((thread+1)*chunks_per_thread, st->num_chunks); chunk++) {
+      int32_t to = min((chunk+1)*st->s, st->n) - 1;
+      partial_leaves += count_leaves(st, chunk*st->s, to);
+      st->l_prime[chunk] = partial_leaves;
+    }
+  }
+
+  // Final prefix computations. The last chunk of each thread is updated
+  // sequentially and then used to update the remaining chunks in parallel
+  for(unsigned int thread = 1; thread < num_threads; thread++) {
+    long last = min((thread+1)*chunks_per_thread, st->num_chunks) - 1;
+    if(last >= thread*chunks_per_thread)
+      st->l_prime[last] += st->l_prime[thread*chunks_per_thread-1];
+  }
+
+  cilk_for(unsigned int thread = 1; thread < num_threads; thread++) {
+    long last = min((thread+1)*chunks_per_thread, st->num_chunks) - 1;
+    for(long chunk = thread*chunks_per_thread; chunk < last; chunk++)
+      st->l_prime[chunk] += st->l_prime[thread*chunks_per_thread-1];
+  }
+}
+
+int32_t leaf_rank(rmMt* st, int32_t i) {
+  if(i < 0)
+    return 0;
+  if(i >= st->n)
+    i = st->n-1;
+
+  long chunk = i/st->s;
+  int32_t rank = chunk ? st->l_prime[chunk-1] : 0;
+
+  return rank + count_leaves(st, chunk*st->s, i);
+}
+
+int32_t leaf_select(rmMt* st, int32_t t) {
+  if(t <= 0 || t > st->l_prime[st->num_chunks-1])
+    return -1;
+
+  // Binary search of the first chunk with at least t leaves
+  long lo = 0, hi = st->num_chunks-1;
+  while(lo < hi) {
+    long mid = (lo+hi)/2;
+    if(st->l_prime[mid] >= t)
+      hi = mid;
+    else
+      lo = mid+1;
+  }
+
+  int32_t rank = lo ? st->l_prime[lo-1] : 0;
+  for(long k = (lo*st->s) >> logW; ; k++) {
+    word_t w = leaf_word(st, k);
+    int32_t count = __builtin_popcountl(w);
+
+    if(rank + count >= t) {
+      for(; rank+1 < t; rank++)
+	w &= w-1; // It removes the lowest leaf
+      return k*word_size + __builtin_ctzl(w);
+    }
+    rank += count;
+  }
+}
+
+int32_t leftmost_leaf(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  return leaf_select(st, leaf_rank(st, i-1)+1);
+}
+
+int32_t rightmost_leaf(rmMt* st, int32_t i) {
+  if(bit_array_get_bit(st->bit_array,i))
+    i = find_close(st, i);
+
+  return leaf_select(st, leaf_rank(st, i));
+}
+
+int32_t leaf_count(rmMt* st, int32_t i) {
+  if(!bit_array_get_bit(st->bit_array,i))
+    i = find_open(st, i);
+
+  return leaf_rank(st, find_close(st, i)) - leaf_rank(st, i-1);
+}
@@ -50,7 +50,19 @@ struct rmMt_t {
   depth_t* e_prime; // num_chunks leaves (it does not need internal nodes)
   depth_t* m_prime; // num_chunks leaves plus internal nodes
   depth_t* M_prime; // num_chunks leaves plus internal nodes
-  int16_t* n_prime; // num_chunks leaves plus internal nodes
+  int32_t* n_prime; // num_chunks leaves plus internal nodes
+  int32_t* l_prime; // num_chunks leaves, number of leaves up to each chunk
+                    // (NULL until st_create_leaves is called)
+  depth_t* e_delta; // Fenwick tree of the pending shifts of the excess values
+                    // of the chunks (NULL if there are none, see
+                    // st_update_range)
+
+  // Directory of pioneers (see pioneer.h), NULL if it is not built
+  struct pioneer_t* pioneers;
+
+  // Number of chunks scanned linearly by find_close/find_open before going up
+  // in the min-max tree (see st_calibrate)
+  unsigned int scan_chunks;
 
   // Input bitarray
   BIT_ARRAY* bit_array;
@@ -67,19 +79,58 @@ rmMt* st_create(BIT_ARRAY* B, unsigned long n);
 rmMt* st_create_emM(BIT_ARRAY* B, unsigned long n);
 rmMt* st_create_il(BIT_ARRAY* B, unsigned long n);
 
+// Optional pass that computes the directory of leaves (l') of an rmMt. It is
+// required by the leaf operations
+void st_create_leaves(rmMt* st);
+
+// Default and maximal number of chunks scanned linearly by find_close and
+// find_open before going up in the min-max tree
+#define SCAN_CHUNKS 8
+#define MAX_SCAN_CHUNKS 1024
+
+// Optional micro-benchmark that sets st->scan_chunks to the number of leaves of
+// the min-max tree that can be scanned linearly in the time of a search that
+// goes up and down the tree. It returns the new value
+unsigned int st_calibrate(rmMt* st);
+
+/*
+ * Incremental updates. The bits B[from..to] of the input bit array have been
+ * rewritten in place (the length does not change). st_update_range
+ * recomputes e', m', M' and n' of the chunks of the range and of their
+ * ancestors in the min-max tree, in O(to-from+s+log n) time. If the excess
+ * at the end of the range changes, the excess values of the following chunks
+ * are shifted lazily: the shift is recorded in st->e_delta and the values of
+ * those chunks and nodes are kept relative to it, so further updates stay
+ * consistent. st_flush_updates applies the pending shifts in parallel, and
+ * it is required by the queries after such updates (balanced rewrites, such
+ * as reordering children, never shift the excess).
+ *
+ * The optional directories of leaves and pioneers are freed by the updates,
+ * and can be rebuilt with st_create_leaves and st_create_pioneers.
+ */
+void st_update_range(rmMt* st, unsigned long from, unsigned long to);
+void st_flush_updates(rmMt* st);
+
 void print_rmMt(rmMt *);
 
 unsigned long size_rmMt(rmMt *);
+// It frees st, including its bit array and its optional directories
+void st_free(rmMt* st);
 
 /* Operations */
 
 // It returns the position of the closing parenthesis that matches the openning
 // parenthesis at position i. It is defined in the paper of Navarro and Sadakane
+// find_close and find_open first check the chunk of i, then scan linearly the
+// next st->scan_chunks leaves of the min-max tree and finally go up and down
+// the tree. find_close_tree and find_open_tree always use the tree
 int32_t find_close(rmMt* st, int32_t i);
+int32_t find_close_tree(rmMt* st, int32_t i);
 int32_t find_close_naive(rmMt* st, int32_t i);
 int32_t find_close_semi(rmMt* st, int32_t i);
 
 int32_t find_open(rmMt* st, int32_t i);
+int32_t find_open_tree(rmMt* st, int32_t i);
 int32_t find_open_naive(rmMt* st, int32_t i);
 int32_t find_open_semi(rmMt* st, int32_t i);
 
@@ -87,6 +138,10 @@ int32_t find_open_semi(rmMt* st, int32_t i);
 // It is defined in the paper of Navarro and Sadakane
 int32_t fwd_search(rmMt* st, int32_t i, int32_t d);
 
+// Implementation of the primitive operation bwd_search(P,\pi,i,d)
+// It returns the largest j <= i such that sum(P,\pi,0,j-1) = sum(P,\pi,0,i)-d
+int32_t bwd_search(rmMt* st, int32_t i, int32_t d);
+
 // Implementation of the primitive operation sum(P,\pi,i,j)
 // It is defined in the paper of Navarro and Sadakane
 // It is equivalent to the depth of the ith node or the excess value at ith position
@@ -116,10 +171,180 @@ int32_t select_0(rmMt* st, int32_t i);
 // select_{1}(P,i) = min{j|j \ge 0, sum(P,\pi,0,j) = 2i-j-1}
 int32_t select_1(rmMt* st, int32_t i);
 
+// It returns the position of the first 0 after position i, or -1 if there is
+// none. It scans by words the rest of the chunk of i+1, and farther zeros
+// are found with rank_0 and select_0
+int32_t next_0(rmMt* st, int32_t i);
+
+// It returns the position of the last 0 before position i, or -1 if there is
+// none. It is the symmetric of next_0
+int32_t prev_0(rmMt* st, int32_t i);
+
 int32_t match(rmMt *, int32_t);
 int32_t match_naive(rmMt *, int32_t);
 int32_t match_semi(rmMt *, int32_t);
 
+/* Range minimum queries */
+
+// Implementation of the primitive operation min_excess(P,i,j)
+// It is defined in the paper of Navarro and Sadakane
+// It returns the minimum excess value in the range [i,j]
+int32_t min_excess(rmMt* st, int32_t i, int32_t j);
+
+// Implementation of the primitive operation rmq(P,i,j)
+// It is defined in the paper of Navarro and Sadakane
+// It returns the leftmost position of the minimum excess value in [i,j]
+int32_t rmq(rmMt* st, int32_t i, int32_t j);
+
+// Implementation of the primitive operation min_count(P,i,j)
+// It is defined in the paper of Navarro and Sadakane
+// It returns the number of times that the minimum excess value appears in [i,j]
+int32_t rmq_count(rmMt* st, int32_t i, int32_t j);
+
+// Implementation of the primitive operation min_select(P,i,j,t)
+// It is defined in the paper of Navarro and Sadakane
+// It returns the position of the t-th minimum excess value in [i,j] (t >= 1),
+// or -1 if there are less than t minima
+int32_t rmq_select(rmMt* st, int32_t i, int32_t j, int32_t t);
+
+// Implementation of the primitive operation max_excess(P,i,j)
+// It is defined in the paper of Navarro and Sadakane
+// It returns the maximum excess value in the range [i,j]
+int32_t max_excess(rmMt* st, int32_t i, int32_t j);
+
+// Implementation of the primitive operation rMq(P,i,j)
+// It is defined in the paper of Navarro and Sadakane
+// It returns the leftmost position of the maximum excess value in [i,j]
+int32_t rmq_max(rmMt* st, int32_t i, int32_t j);
+
+/* Height */
+
+// It returns the height of the tree (number of edges of its longest path
+// from the root). It is stored in the root of the min-max tree
+int32_t height_t(rmMt* st);
+
+// It returns the height of the subtree of the node i (0 for a leaf)
+int32_t subtree_height(rmMt* st, int32_t i);
+
+// It returns the leftmost deepest node of the subtree of the node i
+int32_t deepest_node(rmMt* st, int32_t i);
+
+// It returns the lowest common ancestor of the nodes i and j. Nodes can be
+// referred by their opening or closing parenthesis
+int32_t lca(rmMt* st, int32_t i, int32_t j);
+
+// It returns the number of edges in the path between the nodes i and j
+int32_t distance(rmMt* st, int32_t i, int32_t j);
+
+/* Level-wise navigation */
+
+// It returns the ancestor of the node i that is k levels above it (the node
+// itself if k = 0), or -1 if the depth of i is not greater than k
+int32_t level_ancestor(rmMt* st, int32_t i, int32_t k);
+
+// It returns the next (previous) node to the right (left) of the node i with
+// the same depth, or -1 if it does not exist
+int32_t level_next(rmMt* st, int32_t i);
+int32_t level_prev(rmMt* st, int32_t i);
+
+// It returns the leftmost (rightmost) node with depth d, or -1 if it does not
+// exist. The root has depth 1
+int32_t level_leftmost(rmMt* st, int32_t d);
+int32_t level_rightmost(rmMt* st, int32_t d);
+
+/* Subtree size, preorder and postorder */
+
+// It returns the number of nodes in the subtree of the node i (including i)
+int32_t subtree_size(rmMt* st, int32_t i);
+
+// Implementation of the operations preorder(i) and preorder_select(t)
+// It is defined in the paper of Navarro and Sadakane
+// preorder(i) = rank_{1}(P,i). Ranks start at 1 (the root)
+int32_t preorder_rank(rmMt* st, int32_t i);
+int32_t preorder_select(rmMt* st, int32_t t);
+
+// Implementation of the operations postorder(i) and postorder_select(t)
+// It is defined in the paper of Navarro and Sadakane
+// postorder(i) = rank_{0}(P,find_close(i)). Ranks start at 1
+int32_t postorder_rank(rmMt* st, int32_t i);
+int32_t postorder_select(rmMt* st, int32_t t);
+
+// It returns 1 if the node i is an ancestor of the node j (or i = j), and 0
+// otherwise. It is defined in the paper of Navarro and Sadakane
+int32_t is_ancestor(rmMt* st, int32_t i, int32_t j);
+
+/* Children of a node */
+
+// Implementation of the operations degree(i), child(i,t) and childrank(i)
+// It is defined in the paper of Navarro and Sadakane
+// They use the number of minima (n') of the min-max tree. child returns the
+// tth child of i (t >= 1), or -1 if it does not exist. The first child has
+// rank 1
+int32_t degree(rmMt* st, int32_t i);
+int32_t child(rmMt* st, int32_t i, int32_t t);
+int32_t child_rank(rmMt* st, int32_t i);
+
+/* Leaves (they require st_create_leaves) */
+
+// Implementation of the operations leafrank(i) and leafselect(t)
+// It is defined in the paper of Navarro and Sadakane
+// leaf_rank returns the number of leaves whose opening parenthesis is at a
+// position <= i. leaf_select returns the tth leaf (t >= 1), or -1 if it does
+// not exist
+int32_t leaf_rank(rmMt* st, int32_t i);
+int32_t leaf_select(rmMt* st, int32_t t);
+
+// It returns the leftmost (rightmost) leaf of the subtree of the node i
+int32_t leftmost_leaf(rmMt* st, int32_t i);
+int32_t rightmost_leaf(rmMt* st, int32_t i);
+
+// It returns the number of leaves of the subtree of the node i
+int32_t leaf_count(rmMt* st, int32_t i);
+
+/* Finger searches */
+
+// A finger caches the excess value at a position of the parentheses sequence.
+// The searches that start at the finger do not compute sum, and the finger
+// moves to their answer, so sequences of nearby queries (e.g. traversals)
+// avoid most of the work of the plain operations
+typedef struct {
+  int32_t pos; // Position of the finger
+  int32_t excess; // Excess value at pos
+} finger_t;
+
+// It places the finger at position i
+void finger_init(rmMt* st, finger_t* f, int32_t i);
+// It moves the finger to position i. Moves of at most s positions only scan
+// the parentheses between the old and the new position
+void finger_move(rmMt* st, finger_t* f, int32_t i);
+
+// fwd_search(f->pos,d) and bwd_search(f->pos,d). The finger moves to the
+// answer, if it exists
+int32_t finger_fwd_search(rmMt* st, finger_t* f, int32_t d);
+int32_t finger_bwd_search(rmMt* st, finger_t* f, int32_t d);
+
+// find_close(f->pos), find_open(f->pos), first_child(f->pos) and
+// next_sibling(f->pos). The finger moves to the answer. When the node has no
+// next sibling, next_sibling returns -1 and leaves the finger at the closing
+// parenthesis of the node
+int32_t finger_find_close(rmMt* st, finger_t* f);
+int32_t finger_find_open(rmMt* st, finger_t* f);
+int32_t finger_first_child(rmMt* st, finger_t* f);
+int32_t finger_next_sibling(rmMt* st, finger_t* f);
+
+/* Scans of a single chunk of the bit array, used by the search primitives */
+
+// Forward scan of the chunk of i, from position i+1, looking for the excess
+// value target, where excess is the excess value at position i. It returns i-1
+// if target is not reached in the chunk
+int32_t check_leaf_r(rmMt* st, int32_t i, int32_t target, int32_t excess);
+// Forward scan of the chunk starting at position i, looking for the excess
+// value d. It returns i-1 if d is not reached in the chunk
+int32_t check_sibling_r(rmMt* st, int32_t i, int32_t d);
+// Backward counterparts of check_leaf_r and check_sibling_r, used by bwd_search
+int32_t check_leaf_l(rmMt* st, int32_t i, int32_t target, int32_t excess);
+int32_t check_sibling_l(rmMt* st, int32_t i, int32_t excess, int32_t d);
+
 int32_t parent_t(rmMt* st, int32_t i);
 int32_t depth(rmMt* st, int32_t i);
 int32_t first_child(rmMt* st, int32_t i);
@@ -0,0 +1,278 @@
+
+/******************************************************************************
+ * tree_arrays.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdlib.h>
+
+#include "tree_arrays.h"
+#include "util.h"
+#include "basic.h"
+
+// Partition of the chunks of the bit array into one block per thread
+static unsigned int num_blocks(rmMt* st, unsigned int* chunks_per_block) {
+  unsigned int blocks = (st->num_chunks < threads) ? st->num_chunks : threads;
+
+  *chunks_per_block = ceil((double)st->num_chunks/blocks);
+
+  return blocks;
+}
+
+// Excess value before position 'from', the first position of a chunk
+static inline int32_t excess_before(rmMt* st, long from) {
+  return from ? st->e_prime[from/st->s - 1] : 0;
+}
+
+int32_t* st_depth_array(rmMt* st) {
+  int32_t* depths = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+  unsigned int chunks_per_block;
+  unsigned int blocks = num_blocks(st, &chunks_per_block);
+
+  cilk_for(unsigned int block = 0; block < blocks; block++) {
+    long from = (long)block*chunks_per_block*st->s;
+    long to = min((long)(block+1)*chunks_per_block*st->s, (long)st->n);
+
+    if(from < to) {
+      int32_t excess = excess_before(st, from);
+      long pre = (from + excess)/2; // Opening parentheses before 'from'
+      long prev = from-1; // Position whose excess value is 'excess'
+
+      for(long w = from >> logW; (w << logW) < to; w++) {
+	word_t bits = st->bit_array->words[w];
+
+	// Next opening parenthesis. The positions between prev and q are
+	// closing parentheses
+	while(bits) {
+	  long q = (w << logW) + ctz_word(bits);
+	  if(q >= to)
+	    break;
+
+	  excess += 2 - (q - prev);
+	  prev = q;
+	  depths[pre++] = excess;
+	  bits &= bits-1;
+	}
+      }
+    }
+  }
+
+  return depths;
+}
+
+int32_t* st_subtree_size_array(rmMt* st) {
+  int32_t* sizes = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+  unsigned int chunks_per_block;
+  unsigned int blocks = num_blocks(st, &chunks_per_block);
+
+  cilk_for(unsigned int block = 0; block < blocks; block++) {
+    long from = (long)block*chunks_per_block*st->s;
+    long to = min((long)(block+1)*chunks_per_block*st->s, (long)st->n);
+
+    if(from < to) {
+      int32_t excess = excess_before(st, from);
+      long pre = (from + excess)/2; // Opening parentheses before 'from'
+
+      // The stack never holds more parentheses than the difference between
+      // the maximum and the minimum excess of the block
+      int32_t min_excess = excess, max_excess = excess;
+      for(long chunk = from/st->s; chunk*st->s < to; chunk++) {
+	min_excess = min(min_excess, st->m_prime[st->internal_nodes + chunk]);
+	max_excess = max(max_excess, st->M_prime[st->internal_nodes + chunk]);
+      }
+      long* stack = (long*)malloc((max_excess - min_excess + 1)*sizeof(long));
+      long* stack_pre = (long*)malloc((max_excess - min_excess + 1)*sizeof(long));
+      long top = 0;
+
+      for(long w = from >> logW; (w << logW) < to; w++) {
+	word_t bits = st->bit_array->words[w];
+	long last = min((long)word_size, to - (w << logW));
+
+	for(long b = 0; b < last; b++, bits >>= 1) {
+	  long i = (w << logW) + b;
+
+	  if(bits & 1) {
+	    stack[top] = i;
+	    stack_pre[top++] = pre++;
+	  }
+	  else if(top > 0) { // Matching parenthesis in the block
+	    top--;
+	    sizes[stack_pre[top]] = (i - stack[top] + 1)/2;
+	  }
+	  // Otherwise, the opening parenthesis is in a previous block, which
+	  // computes its size
+	}
+      }
+
+      // Opening parentheses whose closing parenthesis is in a later block
+      for(long k = 0; k < top; k++)
+	sizes[stack_pre[k]] = (find_close(st, stack[k]) - stack[k] + 1)/2;
+
+      free(stack);
+      free(stack_pre);
+    }
+  }
+
+  return sizes;
+}
+
+// Opening parenthesis in the stack of st_parent_array/st_csr
+struct frame_t {
+  long pos;
+  int32_t pre; // Preorder rank
+  int32_t children; // Number of children seen so far
+  int foreign; // 1 if the opening parenthesis is before the block
+};
+
+/*
+ * It computes the parent (and, if they are not NULL, the rank among its
+ * siblings and the degree) of each node. The degree of a node is computed by
+ * the block of its opening parenthesis.
+ */
+static void decode(rmMt* st, int32_t* parents, int32_t* ranks,
+		   int32_t* degrees) {
+  unsigned int chunks_per_block;
+  unsigned int blocks = num_blocks(st, &chunks_per_block);
+
+  cilk_for(unsigned int block = 0; block < blocks; block++) {
+    long from = (long)block*chunks_per_block*st->s;
+    long to = min((long)(block+1)*chunks_per_block*st->s, (long)st->n);
+
+    if(from < to) {
+      int32_t excess = excess_before(st, from);
+      int32_t pre = (from + excess)/2; // Opening parentheses before 'from'
+
+      // See st_subtree_size_array. The parent of the first node of the stack
+      // may be before the block
+      int32_t min_excess = excess, max_excess = excess;
+      for(long chunk = from/st->s; chunk*st->s < to; chunk++) {
+	min_excess = min(min_excess, st->m_prime[st->internal_nodes + chunk]);
+	max_excess = max(max_excess, st->M_prime[st->internal_nodes + chunk]);
+      }
+      struct frame_t* stack = (struct frame_t*)malloc((max_excess - min_excess + 2)*
+						      sizeof(struct frame_t));
+      long top = 0;
+
+      for(long w = from >> logW; (w << logW) < to; w++) {
+	word_t bits = st->bit_array->words[w];
+	long last = min((long)word_size, to - (w << logW));
+
+	for(long b = 0; b < last; b++, bits >>= 1) {
+	  long i = (w << logW) + b;
+
+	  if(bits & 1) {
+	    if(top == 0 && i > 0) { // The parent is before the block
+	      int32_t p = parent_t(st, i);
+	      stack[0].pos = p;
+	      stack[0].pre = preorder_rank(st, p) - 1;
+	      stack[0].children = ranks ? child_rank(st, i) - 1 : 0;
+	      stack[0].foreign = 1;
+	      top = 1;
+	    }
+
+	    if(top == 0) // The root
+	      parents[pre] = -1;
+	    else {
+	      parents[pre] = stack[top-1].pre;
+	      int32_t rank = stack[top-1].children++;
+	      if(ranks)
+		ranks[pre] = rank;
+	    }
+
+	    stack[top].pos = i;
+	    stack[top].pre = pre++;
+	    stack[top].children = 0;
+	    stack[top++].foreign = 0;
+	  }
+	  else if(top > 0) {
+	    top--;
+	    if(degrees && !stack[top].foreign)
+	      degrees[stack[top].pre] = stack[top].children;
+	  }
+	}
+      }
+
+      // Opening parentheses whose closing parenthesis is in a later block
+      if(degrees)
+	for(long k = 0; k < top; k++)
+	  if(!stack[k].foreign)
+	    degrees[stack[k].pre] = degree(st, stack[k].pos);
+
+      free(stack);
+    }
+  }
+}
+
+int32_t* st_parent_array(rmMt* st) {
+  int32_t* parents = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+
+  decode(st, parents, NULL, NULL);
+
+  return parents;
+}
+
+int32_t* st_degree_array(rmMt* st) {
+  int32_t* parents = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+  int32_t* degrees = (int32_t*)malloc((st->n/2)*sizeof(int32_t));
+
+  decode(st, parents, NULL, degrees);
+  free(parents);
+
+  return degrees;
+}
+
+csr_tree* st_csr(rmMt* st) {
+  csr_tree* csr = (csr_tree*)malloc(sizeof(csr_tree));
+  long nodes = st->n/2;
+  int32_t* ranks = (int32_t*)malloc(nodes*sizeof(int32_t));
+
+  csr->num_nodes = nodes;
+  csr->parents = (int32_t*)malloc(nodes*sizeof(int32_t));
+  csr->offsets = (int32_t*)malloc((nodes+1)*sizeof(int32_t));
+  csr->children = (int32_t*)malloc(max(nodes-1, 1)*sizeof(int32_t));
+
+  // The degrees are stored in offsets[1..nodes]
+  decode(st, csr->parents, ranks, csr->offsets+1);
+
+  // Prefix sum of the degrees
+  csr->offsets[0] = 0;
+  prefix_sum_32(csr->offsets+1, nodes);
+
+  // Each node is placed in the list of its parent
+  cilk_for(long v = 1; v < nodes; v++)
+    csr->children[csr->offsets[csr->parents[v]] + ranks[v]] = v;
+
+  free(ranks);
+
+  return csr;
+}
+
+void free_csr(csr_tree* csr) {
+  free(csr->parents);
+  free(csr->offsets);
+  free(csr->children);
+  free(csr);
+}
@@ -0,0 +1,75 @@
+
+/******************************************************************************
+ * tree_arrays.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef TREE_ARRAYS_H
+#define TREE_ARRAYS_H
+
+#include "succinct_tree.h"
+
+/*
+ * Bulk computation of per-node arrays, indexed by preorder rank (the root has
+ * rank 0). The bit array is split into blocks of consecutive chunks, one per
+ * thread, as in st_create. Each block is scanned once. Nodes whose matching
+ * parenthesis is outside their block are resolved with the min-max tree.
+ */
+
+// Depth of each node (the root has depth 1). The depths are a prefix sum of
+// the excess, starting at each block from e'
+int32_t* st_depth_array(rmMt* st);
+
+// Number of nodes of the subtree of each node. The opening parentheses of a
+// block are matched with a stack. The ones without their closing parenthesis
+// in the block use find_close
+int32_t* st_subtree_size_array(rmMt* st);
+
+// Preorder rank of the parent of each node (-1 for the root). The opening
+// parentheses of a block are matched with a stack. When the stack is empty,
+// the parent is outside the block and it is found with parent_t
+int32_t* st_parent_array(rmMt* st);
+
+// Number of children of each node. It is computed by the same scan of
+// st_parent_array; the nodes that close in a later block use degree
+int32_t* st_degree_array(rmMt* st);
+
+// Children lists of the tree in compressed sparse row format
+typedef struct {
+  long num_nodes;
+  int32_t* parents; // Preorder rank of the parent of each node (-1 for the root)
+  int32_t* offsets; // num_nodes+1 entries
+  int32_t* children; // The children of the node v, in preorder, are
+                     // children[offsets[v]] ... children[offsets[v+1]-1]
+} csr_tree;
+
+// It decodes the tree into CSR format. The same scan of st_parent_array
+// computes the rank of each node among its siblings and the degree of each
+// node. The offsets are a prefix sum of the degrees
+csr_tree* st_csr(rmMt* st);
+void free_csr(csr_tree* csr);
+
+#endif // TREE_ARRAYS_H
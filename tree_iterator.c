@@ -0,0 +1,110 @@
+
+/******************************************************************************
+ * tree_iterator.c
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include "tree_iterator.h"
+#include "util.h"
+
+// It returns the bit at position j of the bit array, without bound checks
+static inline int get_bit(BIT_ARRAY* bit_array, long j) {
+  return (bit_array->words[j>>logW] >> (j&(word_size-1))) & 1;
+}
+
+void dfs_init(rmMt* st, dfs_iterator* it) {
+  it->pos = -1;
+  it->depth = 0;
+  it->preorder = 0;
+  it->is_leaf = 0;
+  it->bit_array = st->bit_array;
+  it->n = st->n;
+  it->word_idx = 0;
+  it->word = (st->n > 0) ? st->bit_array->words[0] : 0;
+}
+
+int dfs_next(dfs_iterator* it) {
+  word_t w = it->word;
+
+  // Skip the words without opening parentheses
+  while(!w) {
+    it->word_idx++;
+    if((it->word_idx << logW) >= it->n)
+      return 0;
+    w = it->bit_array->words[it->word_idx];
+  }
+
+  long q = (it->word_idx << logW) + ctz_word(w);
+  if(q >= it->n)
+    return 0;
+
+  // The positions between the previous node and q are closing parentheses
+  it->depth += 2 - (q - it->pos);
+  it->pos = q;
+  it->preorder++;
+  it->is_leaf = !get_bit(it->bit_array, q+1);
+  it->word = w & (w-1); // Remove the bit of q
+
+  return 1;
+}
+
+void bfs_init(rmMt* st, bfs_iterator* it) {
+  it->pos = -1;
+  it->depth = 0;
+  it->rank = 0;
+  it->is_leaf = 0;
+  it->st = st;
+}
+
+int bfs_next(bfs_iterator* it) {
+  int32_t next;
+
+  if(it->depth < 0) // The traversal is finished
+    return 0;
+
+  if(it->pos < 0) { // The root
+    next = (it->st->n > 0) ? 0 : -1;
+    it->depth = 1;
+  }
+  else {
+    next = level_next(it->st, it->pos);
+    if(next < 0) { // Leftmost node of the next level
+      next = level_leftmost(it->st, it->depth+1);
+      it->depth++;
+    }
+  }
+
+  if(next < 0) {
+    it->depth = -1;
+    return 0;
+  }
+
+  it->pos = next;
+  it->rank++;
+  it->is_leaf = !get_bit(it->st->bit_array, next+1);
+
+  return 1;
+}
@@ -0,0 +1,83 @@
+
+/******************************************************************************
+ * tree_iterator.h
+ *
+ * Parallel construction of succinct trees
+ * For more information: http://www.inf.udec.cl/~josefuentes/sea2015/
+ *
+ ******************************************************************************
+ * Copyright (C) 2015 José Fuentes Sepúlveda <jfuentess@udec.cl>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef TREE_ITERATOR_H
+#define TREE_ITERATOR_H
+
+#include "succinct_tree.h"
+
+/*
+ * Traversals of the whole tree that do not allocate memory. The preorder
+ * (DFS) iterator is a left-to-right scan of the words of the bit array: the
+ * next node is the next 1 bit, found with a count of trailing zeros, and its
+ * depth follows from the number of 0 bits skipped. It does not use the
+ * min-max tree. The level-order (BFS) iterator visits the nodes level by
+ * level with level_leftmost and level_next.
+ *
+ * Usage:
+ *   dfs_iterator it;
+ *   dfs_init(st, &it);
+ *   while(dfs_next(&it)) { ... it.pos, it.depth, it.preorder, it.is_leaf ... }
+ */
+
+typedef struct {
+  int32_t pos; // Opening parenthesis of the current node
+  int32_t depth; // Depth of the current node (the root has depth 1)
+  int32_t preorder; // Preorder rank of the current node (the root has rank 1)
+  int is_leaf; // 1 if the current node is a leaf
+
+  // Internal state
+  BIT_ARRAY* bit_array;
+  long n;
+  long word_idx; // Index of the word of the next nodes
+  word_t word; // Bits of that word that have not been visited
+} dfs_iterator;
+
+void dfs_init(rmMt* st, dfs_iterator* it);
+// It moves to the next node in preorder. It returns 0 when all the nodes
+// have been visited
+int dfs_next(dfs_iterator* it);
+
+typedef struct {
+  int32_t pos; // Opening parenthesis of the current node
+  int32_t depth; // Depth of the current node (the root has depth 1)
+  int32_t rank; // Level-order rank of the current node (the root has rank 1)
+  int is_leaf; // 1 if the current node is a leaf
+
+  // Internal state
+  rmMt* st;
+} bfs_iterator;
+
+void bfs_init(rmMt* st, bfs_iterator* it);
+// It moves to the next node in level order. The nodes of a level are visited
+// from left to right, so it->depth changes only when a level is finished. It
+// returns 0 when all the nodes have been visited
+int bfs_next(bfs_iterator* it);
+
+#endif // TREE_ITERATOR_H
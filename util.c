@@ -31,6 +31,7 @@
 #include <string.h>
 
 #include "util.h"
+#include "basic.h"
 
 BIT_ARRAY* parentheses_to_bits(const char* fn, long* n) {
   
@@ -62,3 +63,46 @@ BIT_ARRAY* parentheses_to_bits(const char* fn, long* n) {
   return B;
 
 }
+
+// Each block computes its local prefix sum, the last values of the blocks
+// are updated sequentially and then they are used to update the remaining
+// values in parallel. The same code is generated for each type of value
+#define PREFIX_SUM(name, type)						\
+  void name(type* a, long m) {						\
+    unsigned int blocks = (m < threads) ? 1 : threads;			\
+    long per_block = (m + blocks - 1)/blocks;				\
+									\
+    cilk_for(unsigned int b = 0; b < blocks; b++) {			\
+      long last = min((b+1)*per_block, m);				\
+      for(long i = b*per_block+1; i < last; i++)			\
+	a[i] += a[i-1];							\
+    }									\
+    for(unsigned int b = 1; b < blocks; b++) {				\
+      long last = min((b+1)*per_block, m) - 1;				\
+      if(last >= b*per_block)						\
+	a[last] += a[b*per_block-1];					\
+    }									\
+    cilk_for(unsigned int b = 1; b < blocks; b++) {			\
+      long last = min((b+1)*per_block, m) - 1;				\
+      for(long i = b*per_block; i < last; i++)				\
+	a[i] += a[b*per_block-1];					\
+    }									\
+  }
+
+PREFIX_SUM(prefix_sum, long)
+PREFIX_SUM(prefix_sum_32, int32_t)
+
+void set_bit_range(BIT_ARRAY* B, long from, long to, long lo, long hi) {
+  while(from < to) {
+    long w = from >> logW;
+    long end = min(to, (w+1) << logW);
+    word_t mask = (end - from == word_size) ? ~(word_t)0 :
+      (((word_t)1 << (end - from)) - 1) << (from & (word_size-1));
+
+    if((w << logW) >= lo && ((w+1) << logW) <= hi)
+      B->words[w] |= mask;
+    else
+      __sync_fetch_and_or(&B->words[w], mask);
+    from = end;
+  }
+}
@@ -30,8 +30,20 @@
 
 BIT_ARRAY* parentheses_to_bits(const char* fn, long* n);
 
+// Inclusive prefix sum of a[0..m-1], computed in parallel by blocks
+void prefix_sum(long* a, long m);
+void prefix_sum_32(int32_t* a, long m);
+
+// It sets the bits [from, to) of B. The words that are not completely inside
+// [lo, hi) may be shared with other threads, so they are set atomically
+void set_bit_range(BIT_ARRAY* B, long from, long to, long lo, long hi);
+
 #ifdef ARCH64
 #define logW 6
+#define ctz_word(w) __builtin_ctzl(w) // Number of trailing zeros of a word
+#define clz_word(w) __builtin_clzl(w) // Number of leading zeros of a word
 #else
 #define logW 5
+#define ctz_word(w) __builtin_ctz(w) // Number of trailing zeros of a word
+#define clz_word(w) __builtin_clz(w) // Number of leading zeros of a word
 #endif